@@ -0,0 +1,309 @@
+#include <yinsh-core/match.hpp>
+#include <yinsh-core/system.hpp>
+#include <yinsh-core/tuning.hpp>
+
+#include <charconv>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+static void print_usage(const char* program) {
+    std::fprintf(
+        stderr,
+        "Usage: %s [--move-time S] [--positions N] [--memory MB] [--scheme NAME] [--margin ELO] [--save]\n"
+        "  --move-time  search time per move (default 0.5)\n"
+        "  --positions  reference positions, each is played with both colors (default 16,\n"
+        "               with --save enough for the margin)\n"
+        "  --memory     search tree memory of each engine (default 256)\n"
+        "  --scheme     tree: the threads share one tree, root: every thread grows its own\n"
+        "               tree and they vote, all: compare both (default tree)\n"
+        "  --margin     the smallest thread count within this many Elo of the\n"
+        "               strongest one is chosen (default 30)\n"
+        "  --save       store the chosen thread count of the tree scheme as the default of the game,\n"
+        "               refused when the Elo error of a thread count is wider than the margin\n",
+        program
+    );
+}
+
+static bool parse_positive(std::string_view text, int& result) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result);
+    return error == std::errc{} && end == text.data() + text.size() && result > 0;
+}
+
+static bool parse_positive(const char* text, float& result) {
+    char* end;
+    result = std::strtof(text, &end);
+    return end != text && *end == '\0' && result > 0;
+}
+
+// Elo difference that corresponds to the expected score
+static float score_to_elo(float score) {
+    // Avoid infinities when one side won every game
+    score = std::clamp(score, 0.01f, 0.99f);
+    return -400.f * std::log10(1.f / score - 1.f);
+}
+
+// Positions whose games make the 95% interval of an even score without draws,
+// the widest one near equal strength, as narrow as the margin
+static int get_required_position_count(int elo_margin) {
+    // Slope of the Elo curve at a score of one half
+    const float elo_per_score = 400.f / (std::log(10.f) * 0.25f);
+    const float games = std::pow(1.96f * 0.5f * elo_per_score / elo_margin, 2.f);
+
+    return static_cast<int>(std::ceil(games / 2));
+}
+
+struct ScalingResult {
+    int thread_count;
+    float score;
+    float elo;
+    // Half width of the 95% confidence interval of the Elo
+    float elo_error;
+};
+
+static const char* scheme_name(ParallelScheme scheme) {
+    switch (scheme) {
+    case ParallelScheme::Tree:
+        return "tree";
+    case ParallelScheme::Root:
+        return "root";
+    default:
+        abort();
+    }
+}
+
+// Plays every thread count against one thread of the tree scheme, the
+// first result is the baseline itself
+static std::vector<ScalingResult> measure_scaling(
+    ParallelScheme scheme,
+    const std::vector<int>& thread_counts,
+    const std::vector<std::vector<Yngine::Move>>& positions,
+    float move_time,
+    std::size_t memory_limit
+) {
+    const auto baseline = EngineSettings{1, move_time, memory_limit};
+
+    std::printf(
+        "\nThe %s scheme plays %zu games with every thread count against 1 thread with %.2fs per move\n",
+        scheme_name(scheme),
+        2 * positions.size(),
+        move_time
+    );
+
+    std::vector<ScalingResult> results{ScalingResult{1, 0.5f, 0.f, 0.f}};
+
+    for (const auto thread_count : thread_counts) {
+        const auto tested = EngineSettings{thread_count, move_time, memory_limit, scheme};
+
+        float points = 0;
+        float squared_points = 0;
+        int games = 0;
+
+        for (const auto& opening : positions) {
+            using GameResult = BoardState::GameResult;
+
+            const auto as_white = play_game(opening, tested, baseline).result;
+            const auto white_points = as_white == GameResult::WhiteWon ? 1.f : as_white == GameResult::Draw ? 0.5f : 0.f;
+
+            const auto as_black = play_game(opening, baseline, tested).result;
+            const auto black_points = as_black == GameResult::BlackWon ? 1.f : as_black == GameResult::Draw ? 0.5f : 0.f;
+
+            points += white_points + black_points;
+            squared_points += white_points * white_points + black_points * black_points;
+            games += 2;
+
+            std::printf("\r%3i threads: %i/%zu games", thread_count, games, 2 * positions.size());
+            std::fflush(stdout);
+        }
+
+        const auto score = points / games;
+
+        // Standard error of the mean score, the interval is mapped to Elo at its ends.
+        // A win and a loss are added to the variance so that one sided results aren't certain
+        const auto prior_score = (points + 1.f) / (games + 2);
+        const auto variance = std::max((squared_points + 1.f) / (games + 2) - prior_score * prior_score, 0.f);
+        const auto score_error = 1.96f * std::sqrt(variance / games);
+        const auto elo_error = std::max(
+            score_to_elo(score + score_error) - score_to_elo(score),
+            score_to_elo(score) - score_to_elo(score - score_error)
+        );
+
+        results.push_back(ScalingResult{thread_count, score, score_to_elo(score), elo_error});
+
+        std::printf("\n");
+    }
+
+    // Efficiency is the Elo gained for every doubling of the threads
+    std::printf("\nthreads   score      elo   error   elo/doubling\n");
+    for (const auto& result : results) {
+        if (result.thread_count == 1) {
+            std::printf("%7i   %5.2f   %6.0f       -              -\n", result.thread_count, result.score, result.elo);
+        } else {
+            std::printf(
+                "%7i   %5.2f   %6.0f   %5.0f   %12.0f\n",
+                result.thread_count,
+                result.score,
+                result.elo,
+                result.elo_error,
+                result.elo / std::log2(static_cast<float>(result.thread_count))
+            );
+        }
+    }
+
+    return results;
+}
+
+int main(int argc, char** argv) {
+    float move_time = 0.5f;
+    std::optional<int> position_count{};
+    int memory_limit_mb = 256;
+    int elo_margin = 30;
+    std::vector<ParallelScheme> schemes{ParallelScheme::Tree};
+    bool save = false;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view option = argv[i];
+
+        if (option == "--save") {
+            save = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        const char* value = argv[++i];
+
+        bool is_valid = true;
+        if (option == "--move-time") {
+            is_valid = parse_positive(value, move_time);
+        } else if (option == "--positions") {
+            position_count.emplace();
+            is_valid = parse_positive(value, *position_count);
+        } else if (option == "--memory") {
+            is_valid = parse_positive(value, memory_limit_mb);
+        } else if (option == "--scheme") {
+            const std::string_view name = value;
+
+            if (name == "tree") {
+                schemes = {ParallelScheme::Tree};
+            } else if (name == "root") {
+                schemes = {ParallelScheme::Root};
+            } else if (name == "all") {
+                schemes = {ParallelScheme::Tree, ParallelScheme::Root};
+            } else {
+                is_valid = false;
+            }
+        } else if (option == "--margin") {
+            is_valid = parse_positive(value, elo_margin);
+        } else {
+            is_valid = false;
+        }
+
+        if (!is_valid) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // The game only uses the tree scheme
+    if (save && schemes.front() != ParallelScheme::Tree) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const int required_position_count = get_required_position_count(elo_margin);
+    std::printf(
+        "A margin of %i Elo needs about %i positions (%i games for every thread count) to be saved\n",
+        elo_margin,
+        required_position_count,
+        2 * required_position_count
+    );
+
+    if (!position_count) {
+        position_count = save ? required_position_count : 16;
+    } else if (save && *position_count < required_position_count) {
+        std::fprintf(
+            stderr,
+            "--save needs at least %i positions for a margin of %i Elo, play more --positions or raise --margin\n",
+            required_position_count,
+            elo_margin
+        );
+        return 1;
+    }
+
+    const int system_threads = get_system_threads();
+
+    std::vector<int> thread_counts{};
+    for (int thread_count = 2; thread_count < system_threads; thread_count *= 2) {
+        thread_counts.push_back(thread_count);
+    }
+    if (system_threads > 1) {
+        thread_counts.push_back(system_threads);
+    }
+
+    const auto positions = generate_reference_positions(*position_count, 1);
+    const auto memory_limit = static_cast<std::size_t>(memory_limit_mb) * 1024 * 1024;
+
+    std::vector<ScalingResult> tree_results{};
+
+    for (const auto scheme : schemes) {
+        auto results = measure_scaling(scheme, thread_counts, positions, move_time, memory_limit);
+
+        if (scheme == ParallelScheme::Tree) {
+            tree_results = std::move(results);
+        }
+    }
+
+    // The thread count of the game is only chosen for the tree scheme
+    if (tree_results.empty())
+        return 0;
+
+    float best_elo = 0;
+    float largest_elo_error = 0;
+    for (const auto& result : tree_results) {
+        best_elo = std::max(best_elo, result.elo);
+        largest_elo_error = std::max(largest_elo_error, result.elo_error);
+    }
+
+    int chosen_thread_count = 1;
+    for (const auto& result : tree_results) {
+        if (result.elo >= best_elo - elo_margin) {
+            chosen_thread_count = result.thread_count;
+            break;
+        }
+    }
+
+    std::printf("\nChosen thread count: %i\n", chosen_thread_count);
+
+    // Within the error the choice is noise and would not be worth keeping
+    if (save && largest_elo_error > elo_margin) {
+        std::fprintf(
+            stderr,
+            "Not saved: the Elo error of up to %.0f is wider than the margin of %i, "
+            "play more --positions or raise --margin\n",
+            largest_elo_error,
+            elo_margin
+        );
+        return 1;
+    }
+
+    if (save) {
+        if (!save_tuned_thread_count(chosen_thread_count)) {
+            std::fprintf(stderr, "Could not save the thread count\n");
+            return 1;
+        }
+
+        std::printf("Saved as the default thread count of the game\n");
+    } else {
+        std::printf("Run with --save to use it as the default thread count of the game\n");
+    }
+
+    return 0;
+}
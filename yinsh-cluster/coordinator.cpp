@@ -0,0 +1,349 @@
+#include <yinsh-cluster/coordinator.hpp>
+#include <yinsh-core/notation.hpp>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <sstream>
+
+// Answers to commands other than searches are immediate
+static constexpr auto COMMAND_TIMEOUT = std::chrono::seconds(10);
+// Added to the search time for the network and a worker that waits for threads
+static constexpr auto SEARCH_GRACE = std::chrono::seconds(1);
+
+// Milliseconds until the deadline for poll, at least zero
+static int milliseconds_until(std::chrono::steady_clock::time_point deadline) {
+    const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return static_cast<int>(std::max<long long>(left.count(), 0));
+}
+
+static int connect_to(const std::string& address) {
+    const auto separator = address.rfind(':');
+    if (separator == std::string::npos)
+        return -1;
+
+    const auto host = address.substr(0, separator);
+    const auto port = address.substr(separator + 1);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addresses;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0)
+        return -1;
+
+    int connection = -1;
+    for (auto info = addresses; info; info = info->ai_next) {
+        connection = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (connection < 0)
+            continue;
+
+        if (connect(connection, info->ai_addr, info->ai_addrlen) == 0)
+            break;
+
+        close(connection);
+        connection = -1;
+    }
+
+    freeaddrinfo(addresses);
+
+    if (connection >= 0) {
+        const int no_delay = 1;
+        setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+    }
+
+    return connection;
+}
+
+Coordinator::~Coordinator() {
+    for (const auto& worker : this->workers) {
+        close(worker.connection);
+    }
+}
+
+bool Coordinator::add_worker(const std::string& address) {
+    Worker worker{
+        .address = address,
+        .connection = connect_to(address),
+        .session_id = 0,
+        .buffer = {},
+    };
+
+    if (worker.connection < 0)
+        return false;
+
+    const auto fail = [&worker] {
+        close(worker.connection);
+        return false;
+    };
+
+    if (!send_line(worker, "new"))
+        return fail();
+
+    const auto answer = receive_line(worker, Clock::now() + COMMAND_TIMEOUT);
+    if (!answer)
+        return fail();
+
+    std::istringstream stream{*answer};
+    std::string status;
+    if (!(stream >> status >> worker.session_id) || status != "ok")
+        return fail();
+
+    // A worker that joins during the game catches up with the moves played so far
+    for (const auto move : this->history) {
+        if (!send_line(worker, "play " + std::to_string(worker.session_id) + ' ' + move_to_string(move)))
+            return fail();
+
+        const auto play_answer = receive_line(worker, Clock::now() + COMMAND_TIMEOUT);
+        if (!play_answer || *play_answer != "ok")
+            return fail();
+    }
+
+    this->workers.push_back(std::move(worker));
+    return true;
+}
+
+bool Coordinator::play(Yngine::Move move) {
+    if (!this->board_state.is_move_legal(move))
+        return false;
+
+    this->board_state.apply_move(move);
+    this->history.push_back(move);
+
+    const auto move_string = move_to_string(move);
+
+    for (auto& worker : this->workers) {
+        send_line(worker, "play " + std::to_string(worker.session_id) + ' ' + move_string);
+    }
+
+    const auto deadline = Clock::now() + COMMAND_TIMEOUT;
+
+    for (std::size_t i = this->workers.size(); i-- > 0;) {
+        const auto answer = receive_line(this->workers[i], deadline);
+        if (!answer || *answer != "ok") {
+            this->drop_worker(i, "rejected a move");
+        }
+    }
+
+    return true;
+}
+
+std::optional<Coordinator::Result> Coordinator::search(float seconds) {
+    if (this->board_state.get_next_action() == BoardState::NextAction::GameOver)
+        return std::nullopt;
+
+    // All workers are asked before any answer is read, so they search at the same time
+    for (auto& worker : this->workers) {
+        std::ostringstream command;
+        command << "go " << worker.session_id << ' ' << seconds;
+        send_line(worker, command.str());
+    }
+
+    struct Candidate {
+        Yngine::Move move;
+        std::string name;
+        int votes;
+    };
+
+    // The answers are awaited from all the workers at once, a worker that
+    // stalls doesn't hold back the others past the deadline
+    const auto deadline = Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(seconds)) +
+        SEARCH_GRACE;
+
+    std::vector<std::optional<std::string>> answers(this->workers.size());
+    std::vector<bool> is_waiting(this->workers.size(), true);
+    std::size_t waiting_count = this->workers.size();
+
+    while (waiting_count > 0) {
+        std::vector<pollfd> poll_fds{};
+        std::vector<std::size_t> poll_workers{};
+
+        for (std::size_t i = 0; i < this->workers.size(); i++) {
+            if (!is_waiting[i])
+                continue;
+
+            if ((answers[i] = take_line(this->workers[i]))) {
+                is_waiting[i] = false;
+                waiting_count--;
+                continue;
+            }
+
+            poll_fds.push_back(pollfd{this->workers[i].connection, POLLIN, 0});
+            poll_workers.push_back(i);
+        }
+
+        if (poll_fds.empty())
+            break;
+
+        const auto ready_count = poll(poll_fds.data(), poll_fds.size(), milliseconds_until(deadline));
+        if (ready_count == 0)
+            break;
+
+        if (ready_count < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (std::size_t j = 0; j < poll_fds.size(); j++) {
+            if (poll_fds[j].revents == 0)
+                continue;
+
+            const auto i = poll_workers[j];
+            if (!receive_chunk(this->workers[i])) {
+                is_waiting[i] = false;
+                waiting_count--;
+            }
+        }
+    }
+
+    // Candidates are kept in the order of the workers, so a tie goes to the
+    // move of the worker that was added first
+    std::vector<Candidate> candidates{};
+    int voters = 0;
+
+    // A worker that didn't answer in time would answer this search later,
+    // so it can't be asked again and is dropped as well
+    std::vector<std::size_t> failed_workers{};
+
+    for (std::size_t i = 0; i < this->workers.size(); i++) {
+        const auto& answer = answers[i];
+        if (!answer) {
+            failed_workers.push_back(i);
+            continue;
+        }
+
+        std::istringstream stream{*answer};
+        std::string status;
+        stream >> status;
+
+        // E.g. the worker ran out of memory, it can still take part in later searches
+        if (status != "bestmove")
+            continue;
+
+        const auto move = parse_move(stream);
+        if (!move || !this->board_state.is_move_legal(*move)) {
+            failed_workers.push_back(i);
+            continue;
+        }
+
+        voters++;
+
+        const auto name = move_to_string(*move);
+        auto candidate = std::find_if(
+            candidates.begin(), candidates.end(),
+            [&name](const Candidate& candidate) { return candidate.name == name; }
+        );
+
+        if (candidate == candidates.end()) {
+            candidates.push_back(Candidate{*move, name, 1});
+        } else {
+            candidate->votes++;
+        }
+    }
+
+    for (auto i = failed_workers.rbegin(); i != failed_workers.rend(); i++) {
+        this->drop_worker(*i, is_waiting[*i] ? "did not answer in time" : "failed to search");
+    }
+
+    if (candidates.empty())
+        return std::nullopt;
+
+    const auto best = std::max_element(
+        candidates.begin(), candidates.end(),
+        [](const Candidate& a, const Candidate& b) { return a.votes < b.votes; }
+    );
+
+    return Result{
+        .best_move = best->move,
+        .votes = best->votes,
+        .voters = voters,
+    };
+}
+
+const BoardState& Coordinator::get_board_state() const {
+    return this->board_state;
+}
+
+int Coordinator::get_worker_count() const {
+    return static_cast<int>(this->workers.size());
+}
+
+bool Coordinator::send_line(Worker& worker, const std::string& line) {
+    const auto message = line + '\n';
+
+    std::size_t sent = 0;
+    while (sent < message.size()) {
+        const auto result = send(
+            worker.connection,
+            message.data() + sent,
+            message.size() - sent,
+            MSG_NOSIGNAL
+        );
+
+        if (result <= 0)
+            return false;
+
+        sent += result;
+    }
+
+    return true;
+}
+
+std::optional<std::string> Coordinator::receive_line(Worker& worker, Clock::time_point deadline) {
+    while (true) {
+        if (auto line = take_line(worker))
+            return line;
+
+        pollfd poll_fd{worker.connection, POLLIN, 0};
+        const auto ready_count = poll(&poll_fd, 1, milliseconds_until(deadline));
+
+        if (ready_count < 0 && errno == EINTR)
+            continue;
+
+        if (ready_count <= 0 || !receive_chunk(worker))
+            return std::nullopt;
+    }
+}
+
+std::optional<std::string> Coordinator::take_line(Worker& worker) {
+    const auto line_end = worker.buffer.find('\n');
+    if (line_end == std::string::npos)
+        return std::nullopt;
+
+    auto line = worker.buffer.substr(0, line_end);
+    worker.buffer.erase(0, line_end + 1);
+
+    if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+
+    return line;
+}
+
+bool Coordinator::receive_chunk(Worker& worker) {
+    char chunk[4096];
+    const auto received = recv(worker.connection, chunk, sizeof(chunk), 0);
+    if (received <= 0)
+        return false;
+
+    worker.buffer.append(chunk, received);
+    return true;
+}
+
+void Coordinator::drop_worker(std::size_t index, const char* reason) {
+    auto& worker = this->workers[index];
+
+    std::fprintf(stderr, "Dropping worker %s, it %s\n", worker.address.c_str(), reason);
+
+    close(worker.connection);
+    this->workers.erase(this->workers.begin() + index);
+}
@@ -0,0 +1,73 @@
+#ifndef YINSH_CLUSTER_COORDINATOR_HPP
+#define YINSH_CLUSTER_COORDINATOR_HPP
+
+#include <yinsh-core/board.hpp>
+
+#include <yngine/moves.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Searches one position on several Yinsh-server processes at once, every
+// worker grows its own tree and the best moves they return are merged by vote
+class Coordinator {
+public:
+    struct Result {
+        Yngine::Move best_move;
+        int votes;
+        // Workers that answered the search
+        int voters;
+    };
+
+    Coordinator() = default;
+    Coordinator(Coordinator &&) = delete;
+    Coordinator &operator=(Coordinator &&) = delete;
+    Coordinator(const Coordinator &) = delete;
+    Coordinator &operator=(const Coordinator &) = delete;
+    ~Coordinator();
+
+    // Connects to a worker given as host:port and opens a session on it,
+    // returns false if the worker can't be reached
+    bool add_worker(const std::string& address);
+
+    // Returns false if the move is illegal
+    bool play(Yngine::Move move);
+
+    // Workers that fail or don't answer shortly after the search time are
+    // dropped, returns nothing if none of them answered
+    std::optional<Result> search(float seconds);
+
+    const BoardState& get_board_state() const;
+    int get_worker_count() const;
+
+private:
+    struct Worker {
+        std::string address;
+        int connection;
+        int session_id;
+        // Received bytes that don't form a full line yet
+        std::string buffer;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    static bool send_line(Worker& worker, const std::string& line);
+    // Returns nothing if the connection fails or the deadline passes first
+    static std::optional<std::string> receive_line(Worker& worker, Clock::time_point deadline);
+    // Takes a full line that was already received
+    static std::optional<std::string> take_line(Worker& worker);
+    // Reads what is available once, returns false if the connection is closed
+    static bool receive_chunk(Worker& worker);
+
+    void drop_worker(std::size_t index, const char* reason);
+
+    BoardState board_state;
+    std::vector<Yngine::Move> history;
+
+    std::vector<Worker> workers;
+};
+
+#endif // YINSH_CLUSTER_COORDINATOR_HPP
@@ -0,0 +1,101 @@
+#include <yinsh-cluster/coordinator.hpp>
+#include <yinsh-core/notation.hpp>
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static void print_usage(const char* program) {
+    std::fprintf(
+        stderr,
+        "Usage: %s --worker HOST:PORT [--worker HOST:PORT ...]\n"
+        "  --worker  a Yinsh-server started with --port, every worker searches the\n"
+        "            same position and the moves they find are merged by vote\n"
+        "\n"
+        "Commands are read from the standard input, one per line:\n"
+        "  play <move>     -> ok\n"
+        "  go <seconds>    -> bestmove <move> <votes>/<workers that answered>\n"
+        "  workers         -> ok <connected workers>\n"
+        "  quit\n",
+        program
+    );
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> worker_addresses{};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view option = argv[i];
+
+        if (option != "--worker" || i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        worker_addresses.push_back(argv[++i]);
+    }
+
+    if (worker_addresses.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    Coordinator coordinator{};
+
+    for (const auto& address : worker_addresses) {
+        if (!coordinator.add_worker(address)) {
+            std::fprintf(stderr, "Could not connect to worker %s\n", address.c_str());
+        }
+    }
+
+    if (coordinator.get_worker_count() == 0) {
+        std::fprintf(stderr, "No workers are available\n");
+        return 1;
+    }
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream stream{line};
+
+        std::string command;
+        if (!(stream >> command))
+            continue;
+
+        if (command == "play") {
+            const auto move = parse_move(stream);
+            if (!move) {
+                std::cout << "error malformed move" << std::endl;
+            } else if (!coordinator.play(*move)) {
+                std::cout << "error illegal move" << std::endl;
+            } else {
+                std::cout << "ok" << std::endl;
+            }
+        } else if (command == "go") {
+            float seconds;
+            if (!(stream >> seconds) || seconds <= 0) {
+                std::cout << "error expected search time in seconds" << std::endl;
+                continue;
+            }
+
+            const auto result = coordinator.search(seconds);
+            if (!result) {
+                std::cout << "error no worker found a move" << std::endl;
+            } else {
+                std::cout
+                    << "bestmove " << move_to_string(result->best_move)
+                    << ' ' << result->votes << '/' << result->voters << std::endl;
+            }
+        } else if (command == "workers") {
+            std::cout << "ok " << coordinator.get_worker_count() << std::endl;
+        } else if (command == "quit") {
+            break;
+        } else {
+            std::cout << "error unknown command" << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <yinsh-core/analysis.hpp>
+#include <yinsh-core/notation.hpp>
+#include <yinsh-core/profiler.hpp>
+
+#include <yngine/mcts.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+
+static std::unique_ptr<Yngine::MCTS> create_engine(
+    const std::vector<Yngine::Move>& history,
+    std::size_t memory_limit
+) {
+    auto engine = std::make_unique<Yngine::MCTS>(memory_limit);
+
+    for (const auto move : history) {
+        engine->apply_move(move);
+    }
+
+    return engine;
+}
+
+// Points of the player who was to move in the position, a draw is half a point
+static float play_random_game(BoardState board_state, bool white, std::mt19937& random) {
+    while (board_state.get_next_action() != BoardState::NextAction::GameOver) {
+        const auto legal_moves = board_state.get_legal_moves();
+        board_state.apply_move(legal_moves[random() % legal_moves.size()]);
+    }
+
+    switch (board_state.get_game_result()) {
+    case BoardState::GameResult::WhiteWon:
+        return white ? 1.f : 0.f;
+    case BoardState::GameResult::BlackWon:
+        return white ? 0.f : 1.f;
+    default:
+        return 0.5f;
+    }
+}
+
+std::vector<RootMove> analyze_position(
+    const std::vector<Yngine::Move>& history,
+    const AnalysisSettings& settings
+) {
+    YINSH_PROFILE_SCOPE("analyze_position");
+
+    BoardState board_state{};
+    for (const auto move : history) {
+        board_state.apply_move(move);
+    }
+
+    if (board_state.get_next_action() == BoardState::NextAction::GameOver)
+        return {};
+
+    // The search runs in the background while the playouts are played here
+    const auto engine = create_engine(history, settings.memory_limit);
+    auto search = engine->search(settings.search_time, settings.thread_count);
+
+    const bool white = board_state.is_whites_move();
+    std::mt19937 random{static_cast<uint32_t>(board_state.get_hash())};
+
+    std::vector<RootMove> result{};
+
+    for (const auto move : board_state.get_legal_moves()) {
+        auto after_move = board_state;
+        after_move.apply_move(move);
+
+        float points = 0;
+        for (int i = 0; i < settings.playouts_per_move; i++) {
+            points += play_random_game(after_move, white, random);
+        }
+
+        result.push_back(RootMove{
+            move,
+            false,
+            settings.playouts_per_move,
+            settings.playouts_per_move > 0 ? points / settings.playouts_per_move : 0.5f,
+            {move},
+        });
+    }
+
+    // Moves are matched by their notation, the same as in the protocols.
+    // A move the rules don't know is a bug of one of them, it isn't marked
+    const auto engine_move = search.get();
+    const auto engine_move_name = move_to_string(engine_move);
+
+    for (auto& root_move : result) {
+        root_move.is_engine_move = move_to_string(root_move.move) == engine_move_name;
+    }
+
+    std::stable_sort(result.begin(), result.end(), [](const RootMove& a, const RootMove& b) {
+        if (a.is_engine_move != b.is_engine_move)
+            return a.is_engine_move;
+
+        return a.playout_score > b.playout_score;
+    });
+
+    if (static_cast<int>(result.size()) > settings.move_count) {
+        result.resize(settings.move_count);
+    }
+
+    // The engine goes on from its own move, so its tree is reused for the replies
+    if (!result.empty() && result.front().is_engine_move) {
+        auto& variation = result.front().principal_variation;
+
+        auto variation_board_state = board_state;
+        variation_board_state.apply_move(engine_move);
+        engine->apply_move(engine_move);
+
+        while (static_cast<int>(variation.size()) < settings.variation_length &&
+               variation_board_state.get_next_action() != BoardState::NextAction::GameOver) {
+            const auto reply = engine->search(settings.search_time, settings.thread_count).get();
+            if (!variation_board_state.is_move_legal(reply))
+                break;
+
+            variation.push_back(reply);
+            variation_board_state.apply_move(reply);
+            engine->apply_move(reply);
+        }
+    }
+
+    return result;
+}
+
+std::size_t get_analysis_memory(const AnalysisSettings& settings) {
+    return settings.memory_limit;
+}
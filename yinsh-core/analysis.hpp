@@ -0,0 +1,57 @@
+#ifndef YINSH_CORE_ANALYSIS_HPP
+#define YINSH_CORE_ANALYSIS_HPP
+
+#include <yinsh-core/board.hpp>
+
+#include <yngine/moves.hpp>
+
+#include <cstddef>
+#include <vector>
+
+struct AnalysisSettings {
+    // Number of root moves that are returned
+    int move_count;
+
+    // One search of the engine, the same as a move of the AI
+    float search_time;
+    int thread_count;
+    std::size_t memory_limit;
+
+    // Every legal root move gets the same number of uniformly random playouts,
+    // they rank the moves that the engine didn't choose
+    int playouts_per_move;
+
+    // Length of the principal variation of the engine's move including it
+    int variation_length;
+};
+
+struct RootMove {
+    Yngine::Move move;
+
+    bool is_engine_move;
+
+    int playouts;
+    // Points of the player to move in the analyzed position from the random
+    // playouts after the move, a draw is half a point. It isn't the
+    // evaluation of the engine, Yngine doesn't report one
+    float playout_score;
+
+    // The engine's move followed by the replies the engine finds after it,
+    // the other moves only hold themselves
+    std::vector<Yngine::Move> principal_variation;
+};
+
+// Ranks the root moves of the position reached by the moves of history.
+// Yngine only returns the best move of a search, without its evaluation or
+// the statistics of the other moves, so only the engine's move can come from
+// the search. It is ranked first and the other moves follow by their random
+// playout score. The best move_count moves are returned in order
+std::vector<RootMove> analyze_position(
+    const std::vector<Yngine::Move>& history,
+    const AnalysisSettings& settings
+);
+
+// Tree memory of the engine of one analysis
+std::size_t get_analysis_memory(const AnalysisSettings& settings);
+
+#endif // YINSH_CORE_ANALYSIS_HPP
@@ -0,0 +1,704 @@
+#include <yinsh-core/board.hpp>
+#include <yinsh-core/profiler.hpp>
+#include <yinsh-core/utils.hpp>
+
+#include <yngine/bitboard.hpp>
+
+#include <cassert>
+#include <algorithm>
+
+namespace {
+
+constexpr uint64_t split_mix(uint64_t& state) {
+    state += 0x9E3779B97F4A7C15;
+
+    uint64_t result = state;
+    result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9;
+    result = (result ^ (result >> 27)) * 0x94D049BB133111EB;
+
+    return result ^ (result >> 31);
+}
+
+struct ZobristKeys {
+    // Only rings and markers are hashed, indexed by Node - Node::WhiteRing
+    uint64_t pieces[11 * 11][4];
+    uint64_t next_action[5];
+    uint64_t white_moves_next;
+    uint64_t white_made_last_movement;
+};
+
+constexpr ZobristKeys generate_zobrist_keys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x59494E5348;
+
+    for (auto& node_keys : keys.pieces) {
+        for (auto& key : node_keys) {
+            key = split_mix(state);
+        }
+    }
+
+    for (auto& key : keys.next_action) {
+        key = split_mix(state);
+    }
+
+    keys.white_moves_next = split_mix(state);
+    keys.white_made_last_movement = split_mix(state);
+
+    return keys;
+}
+
+constexpr ZobristKeys ZOBRIST_KEYS = generate_zobrist_keys();
+
+// Rows are only looked for in these directions, every row
+// has one window that starts at its first node
+const HVec2 ROW_AXES[3] = {HVec2{1, 0}, HVec2{0, 1}, HVec2{1, -1}};
+
+struct RowWindows {
+    std::array<Yngine::RemoveRowMove, ROW_WINDOW_COUNT> moves;
+
+    // Window that starts at the node along each axis, -1 if it leaves the board
+    int16_t window_at[11 * 11][3];
+
+    // Windows that contain the node, at most five along each axis
+    struct NodeWindows {
+        int16_t windows[15];
+        int count;
+    };
+    NodeWindows windows_of_node[11 * 11];
+};
+
+RowWindows generate_row_windows() {
+    RowWindows result{};
+    const BoardStorage board{};
+
+    const auto is_in_game = [&board](HVec2 pos) {
+        return pos.x >= 0 && pos.y >= 0 && pos.x < 11 && pos.y < 11 &&
+            board.get_at(pos) != Node::NotInGame;
+    };
+
+    int window_count = 0;
+
+    // Same order as the nodes are visited in get_legal_moves
+    for (int32_t y = 0; y < 11; y++) {
+        for (int32_t x = 0; x < 11; x++) {
+            const auto pos = HVec2{x, y};
+
+            for (int axis = 0; axis < 3; axis++) {
+                const auto dir = ROW_AXES[axis];
+                result.window_at[11 * y + x][axis] = -1;
+
+                if (!is_in_game(pos) || !is_in_game(pos + dir * 4))
+                    continue;
+
+                assert(window_count < ROW_WINDOW_COUNT);
+
+                for (int32_t i = 0; i < 5; i++) {
+                    const auto node = pos + dir * i;
+                    auto& node_windows = result.windows_of_node[11 * node.y + node.x];
+                    node_windows.windows[node_windows.count++] = static_cast<int16_t>(window_count);
+                }
+
+                result.moves[window_count] = Yngine::RemoveRowMove{
+                    Yngine::Bitboard::coords_to_index(x, y),
+                    HVec3{pos}.direction_to(pos + dir)
+                };
+
+                result.window_at[11 * y + x][axis] = static_cast<int16_t>(window_count);
+                window_count++;
+            }
+        }
+    }
+
+    assert(window_count == ROW_WINDOW_COUNT);
+
+    return result;
+}
+
+const RowWindows& get_row_windows() {
+    static const RowWindows row_windows = generate_row_windows();
+    return row_windows;
+}
+
+}
+
+BoardStorage::BoardStorage() : nodes{} {
+    for (int32_t x = 0; x < 11; x++) {
+        for (int32_t y = BOARD_START_OFFSET[x]; y <= BOARD_END_OFFSET[x]; y++) {
+            this->at(x, y) = Node::Empty;
+        }
+    }
+}
+
+Node& BoardStorage::at(int32_t x, int32_t y) {
+    assert(x >= 0 && y >= 0 && x < 11 && y < 11);
+
+    return this->nodes[11 * y + x];
+}
+
+Node& BoardStorage::at(HVec2 pos) {
+    assert(pos.x >= 0 && pos.y >= 0 && pos.x < 11 && pos.y < 11);
+
+    return this->nodes[11 * pos.y + pos.x];
+}
+
+Node BoardStorage::get_at(int32_t x, int32_t y) const {
+    assert(x >= 0 && y >= 0 && x < 11 && y < 11);
+
+    return this->nodes[11 * y + x];
+}
+
+Node BoardStorage::get_at(HVec2 pos) const {
+    assert(pos.x >= 0 && pos.y >= 0 && pos.x < 11 && pos.y < 11);
+
+    return this->nodes[11 * pos.y + pos.x];
+}
+
+bool BoardState::is_in_game(HVec2 pos) const {
+    if (pos.x < 0 || pos.y < 0 || pos.x >= 11 || pos.y >= 11) {
+        return false;
+    }
+
+    return this->storage.get_at(pos) != Node::NotInGame;
+}
+
+Node BoardState::get_at(HVec2 pos) const {
+    return this->storage.get_at(pos);
+}
+
+static uint64_t piece_key(HVec2 pos, Node piece) {
+    if (piece == Node::NotInGame || piece == Node::Empty)
+        return 0;
+
+    const auto piece_index = static_cast<int>(piece) - static_cast<int>(Node::WhiteRing);
+    return ZOBRIST_KEYS.pieces[11 * pos.y + pos.x][piece_index];
+}
+
+void BoardState::set_at(HVec2 pos, Node piece) {
+    auto& node = this->storage.at(pos);
+
+    this->pieces_hash ^= piece_key(pos, node) ^ piece_key(pos, piece);
+
+    const auto update_windows = [this, pos](Node marker, int change) {
+        auto& window_markers = marker == Node::WhiteMarker ?
+            this->white_window_markers : this->black_window_markers;
+        auto& row_count = marker == Node::WhiteMarker ?
+            this->white_row_count : this->black_row_count;
+
+        const auto& node_windows = get_row_windows().windows_of_node[11 * pos.y + pos.x];
+        for (int i = 0; i < node_windows.count; i++) {
+            auto& markers = window_markers[node_windows.windows[i]];
+
+            row_count -= markers == 5;
+            markers += change;
+            row_count += markers == 5;
+        }
+
+        this->marker_count += change;
+    };
+
+    if (node == Node::WhiteMarker || node == Node::BlackMarker) {
+        update_windows(node, -1);
+    }
+
+    if (piece == Node::WhiteMarker || piece == Node::BlackMarker) {
+        update_windows(piece, 1);
+    }
+
+    node = piece;
+}
+
+void BoardState::clear_board() {
+    this->storage = BoardStorage{};
+    this->pieces_hash = 0;
+
+    this->white_window_markers = {};
+    this->black_window_markers = {};
+    this->white_row_count = 0;
+    this->black_row_count = 0;
+    this->marker_count = 0;
+}
+
+BoardState::State BoardState::get_state() const {
+    return State{
+        this->next_action,
+        this->white_moves_next,
+        this->white_made_last_movement,
+        this->white_rings_on_board,
+        this->black_rings_on_board,
+    };
+}
+
+void BoardState::set_state(const State& state) {
+    this->next_action = state.next_action;
+    this->white_moves_next = state.white_moves_next;
+    this->white_made_last_movement = state.white_made_last_movement;
+    this->white_rings_on_board = state.white_rings_on_board;
+    this->black_rings_on_board = state.black_rings_on_board;
+}
+
+void BoardState::place_ring(HVec2 pos) {
+    assert(this->white_rings_on_board + this->black_rings_on_board < 10);
+    assert(this->get_at(pos) == Node::Empty);
+
+    this->set_at(pos, this->white_moves_next ? Node::WhiteRing : Node::BlackRing);
+
+    if (this->white_moves_next)
+        this->white_rings_on_board++;
+    else
+        this->black_rings_on_board++;
+
+    if (this->black_rings_on_board == 5) {
+        this->next_action = NextAction::RingMovement;
+    }
+
+    this->white_moves_next = !this->white_moves_next;
+}
+
+void BoardState::move_ring(HVec2 from, HVec2 to) {
+    assert(this->get_at(from) == Node::WhiteRing || this->get_at(from) == Node::BlackRing);
+    assert(this->get_at(to) == Node::Empty);
+
+    const auto mover_marker = this->white_moves_next ? Node::WhiteMarker : Node::BlackMarker;
+
+    assert(
+        mover_marker ==
+        (this->storage.get_at(from) == Node::WhiteRing ? Node::WhiteMarker : Node::BlackMarker)
+    );
+
+    this->set_at(to, this->get_at(from));
+    this->set_at(from, mover_marker);
+
+    auto dir = HVec3{to - from};
+    dir /= dir.length();
+
+    auto current_node = from + dir;
+    while (current_node != to) {
+        const auto current_piece = this->get_at(current_node);
+
+        if (current_piece != Node::Empty) {
+            assert(current_piece == Node::WhiteMarker || current_piece == Node::BlackMarker);
+
+            this->set_at(
+                current_node,
+                current_piece == Node::WhiteMarker ? Node::BlackMarker : Node::WhiteMarker
+            );
+        }
+
+        current_node += dir;
+    }
+
+    // After we moved the ring we have to check if we created any rows
+    this->white_made_last_movement = this->white_moves_next;
+    this->check_for_rows_and_change_state();
+
+    // End the game if all the markers are used and no rows can be removed
+    // depends on the check_for_rows_and_change_state to find out whether
+    // any rows can be removed
+    if (this->next_action != NextAction::RowRemoval &&
+        this->marker_count == 51) {
+        this->next_action = NextAction::GameOver;
+    }
+}
+
+BoardState::NextAction BoardState::get_next_action() const {
+    return this->next_action;
+}
+
+BoardState::GameResult BoardState::get_game_result() const {
+    assert(this->next_action == NextAction::GameOver);
+
+    // The player with fewer rings left has removed more of them
+    if (this->white_rings_on_board < this->black_rings_on_board) {
+        return GameResult::WhiteWon;
+    } else if (this->black_rings_on_board < this->white_rings_on_board) {
+        return GameResult::BlackWon;
+    } else {
+        return GameResult::Draw;
+    }
+}
+
+bool BoardState::is_whites_move() const {
+    return this->white_moves_next;
+}
+
+bool BoardState::ring_moves_available() const {
+    const auto correct_ring = this->white_moves_next ?
+        Node::WhiteRing : Node::BlackRing;
+
+    for (int y = 0; y < 11; y++) {
+        for (int x = 0; x < 11; x++) {
+            const auto pos = HVec2{x, y};
+
+            if (this->is_in_game(pos) &&
+                this->get_at(pos) == correct_ring) {
+                const auto moves = this->get_ring_moves(pos);
+                if (moves.size() != 0) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool BoardState::is_move_legal(Yngine::Move move) const {
+    const bool is_legal = std::visit(variant_overloaded{
+        [this](Yngine::PlaceRingMove move) -> bool {
+            if (this->next_action != NextAction::RingPlacement)
+                return false;
+
+            const auto move_pos = to_hvector2(
+                Yngine::Bitboard::index_to_coords(move.index)
+            );
+
+            if (this->is_in_game(move_pos) &&
+                this->get_at(move_pos) == Node::Empty) {
+                return true;
+            } else {
+                return false;
+            }
+        },
+        [this](Yngine::RingMove move) -> bool {
+            if (this->next_action != NextAction::RingMovement)
+                return false;
+
+            const auto from = to_hvector2(Yngine::Bitboard::index_to_coords(move.from));
+
+            if (!this->is_in_game(from))
+                return false;
+
+            const auto correct_ring = this->white_moves_next ?
+                Node::WhiteRing : Node::BlackRing;
+
+            if (this->get_at(from) != correct_ring)
+                return false;
+
+            const auto allowed_moves = this->get_ring_moves(from);
+
+            const auto move_is_allowed =
+                std::find(
+                    allowed_moves.begin(),
+                    allowed_moves.end(),
+                    to_hvector2(Yngine::Bitboard::index_to_coords(move.to))
+                ) != allowed_moves.end();
+
+            return move_is_allowed;
+        },
+        [this](Yngine::RemoveRowMove move) -> bool {
+            if (this->next_action != NextAction::RowRemoval)
+                return false;
+
+            auto from = to_hvector2(Yngine::Bitboard::index_to_coords(move.from));
+            const auto dir = HVec2::from_direction(move.direction);
+
+            if (!this->is_in_game(from) || !this->is_in_game(from + dir * 4))
+                return false;
+
+            // Rows in the other three directions are the same
+            // windows seen from their last node
+            for (int axis = 0; axis < 3; axis++) {
+                if (dir == -ROW_AXES[axis]) {
+                    from = from + dir * 4;
+                } else if (dir != ROW_AXES[axis]) {
+                    continue;
+                }
+
+                const auto window_index = get_row_windows().window_at[11 * from.y + from.x][axis];
+                assert(window_index >= 0);
+
+                const auto& window_markers = this->is_whites_move() ?
+                    this->white_window_markers : this->black_window_markers;
+
+                return window_markers[window_index] == 5;
+            }
+
+            return false;
+        },
+        [this](Yngine::RemoveRingMove move) -> bool {
+            if (this->next_action != NextAction::RingRemoval)
+                return false;
+
+            const auto correct_ring = this->is_whites_move() ?
+                Node::WhiteRing : Node::BlackRing;
+
+            const auto pos = to_hvector2(Yngine::Bitboard::index_to_coords(move.index));
+
+            if (this->is_in_game(pos) &&
+                this->get_at(pos) == correct_ring) {
+                return true;
+            } else {
+                return false;
+            }
+        },
+        [this](Yngine::PassMove move) -> bool {
+            if (this->next_action != NextAction::RingMovement)
+                return false;
+
+            return !this->ring_moves_available();
+        }
+    }, move);
+
+    return is_legal;
+}
+
+void BoardState::apply_move(Yngine::Move move) {
+    YINSH_PROFILE_SCOPE("BoardState::apply_move");
+
+    std::visit(variant_overloaded{
+        [this](Yngine::PlaceRingMove move) {
+            const auto pos = to_hvector2(Yngine::Bitboard::index_to_coords(move.index));
+            this->place_ring(pos);
+        },
+        [this](Yngine::RingMove move) {
+            const auto from = to_hvector2(Yngine::Bitboard::index_to_coords(move.from));
+            const auto to = to_hvector2(Yngine::Bitboard::index_to_coords(move.to));
+            this->move_ring(from, to);
+        },
+        [this](Yngine::RemoveRowMove move) {
+            const auto from = to_hvector2(Yngine::Bitboard::index_to_coords(move.from));
+            const auto dir = HVec2::from_direction(move.direction);
+            const auto to = from + dir * 4;
+            this->remove_row(from, to);
+        },
+        [this](Yngine::RemoveRingMove move) {
+            const auto pos = to_hvector2(Yngine::Bitboard::index_to_coords(move.index));
+            this->remove_ring(pos);
+        },
+        [this](Yngine::PassMove move) {
+            this->white_made_last_movement = !this->white_made_last_movement;
+            this->white_moves_next = !this->white_moves_next;
+        },
+    }, move);
+}
+
+std::vector<HVec2> BoardState::get_ring_moves(HVec2 pos) const {
+    YINSH_PROFILE_SCOPE("BoardState::get_ring_moves");
+
+    const auto expected_ring_color = this->white_moves_next ?
+        Node::WhiteRing : Node::BlackRing;
+
+    assert(this->is_in_game(pos) && this->get_at(pos) == expected_ring_color);
+
+    std::vector<HVec2> result{};
+
+    for (const auto dir : HVec2::Directions) {
+        auto path_pos = pos;
+        bool went_over_markers = false;
+
+        while (true) {
+            path_pos += dir;
+
+            if (!this->is_in_game(path_pos))
+                break;
+
+            const auto piece = this->get_at(path_pos);
+
+            if (piece == Node::WhiteRing || piece == Node::BlackRing)
+                break;
+
+            if (piece == Node::WhiteMarker || piece == Node::BlackMarker) {
+                went_over_markers = true;
+                continue;
+            }
+
+            result.push_back(path_pos);
+
+            if (went_over_markers)
+                break;
+        }
+    }
+
+    return result;
+}
+
+std::vector<Yngine::Move> BoardState::get_legal_moves() const {
+    std::vector<Yngine::Move> result{};
+
+    if (this->next_action == NextAction::RowRemoval) {
+        for (const auto row : this->get_rows(this->white_moves_next)) {
+            result.push_back(row);
+        }
+
+        return result;
+    }
+
+    const auto correct_ring = this->white_moves_next ?
+        Node::WhiteRing : Node::BlackRing;
+
+    for (int32_t y = 0; y < 11; y++) {
+        for (int32_t x = 0; x < 11; x++) {
+            const auto pos = HVec2{x, y};
+
+            if (!this->is_in_game(pos))
+                continue;
+
+            const auto piece = this->get_at(pos);
+            const auto index = Yngine::Bitboard::coords_to_index(x, y);
+
+            switch (this->next_action) {
+            case NextAction::RingPlacement: {
+                if (piece == Node::Empty) {
+                    result.push_back(Yngine::PlaceRingMove{index});
+                }
+            } break;
+            case NextAction::RingMovement: {
+                if (piece == correct_ring) {
+                    for (const auto to : this->get_ring_moves(pos)) {
+                        result.push_back(Yngine::RingMove{
+                            index,
+                            Yngine::Bitboard::coords_to_index(to.x, to.y),
+                            HVec3{pos}.direction_to(to)
+                        });
+                    }
+                }
+            } break;
+            case NextAction::RowRemoval: {
+                // Handled above for the whole board at once
+            } break;
+            case NextAction::RingRemoval: {
+                if (piece == correct_ring) {
+                    result.push_back(Yngine::RemoveRingMove{index});
+                }
+            } break;
+            case NextAction::GameOver: {
+            } break;
+            }
+        }
+    }
+
+    if (this->next_action == NextAction::RingMovement && result.empty()) {
+        result.push_back(Yngine::PassMove{});
+    }
+
+    return result;
+}
+
+std::vector<Yngine::RemoveRowMove> BoardState::get_rows(bool white) const {
+    const auto& window_markers = white ? this->white_window_markers : this->black_window_markers;
+    const auto row_count = white ? this->white_row_count : this->black_row_count;
+
+    std::vector<Yngine::RemoveRowMove> result{};
+    if (row_count == 0)
+        return result;
+
+    result.reserve(row_count);
+
+    const auto& moves = get_row_windows().moves;
+    for (int i = 0; i < ROW_WINDOW_COUNT; i++) {
+        if (window_markers[i] == 5) {
+            result.push_back(moves[i]);
+        }
+    }
+
+    return result;
+}
+
+BoardState BoardState::transformed(Symmetry symmetry) const {
+    BoardState result = *this;
+    result.clear_board();
+
+    for (int32_t y = 0; y < 11; y++) {
+        for (int32_t x = 0; x < 11; x++) {
+            const auto pos = HVec2{x, y};
+
+            if (this->is_in_game(pos)) {
+                result.set_at(symmetry.apply(pos), this->get_at(pos));
+            }
+        }
+    }
+
+    return result;
+}
+
+uint64_t BoardState::get_hash() const {
+    uint64_t hash = this->pieces_hash;
+
+    hash ^= ZOBRIST_KEYS.next_action[static_cast<int>(this->next_action)];
+
+    if (this->white_moves_next)
+        hash ^= ZOBRIST_KEYS.white_moves_next;
+
+    // Decides who moves once the rows made by the last movement are removed
+    if (this->next_action == NextAction::RowRemoval ||
+        this->next_action == NextAction::RingRemoval) {
+        if (this->white_made_last_movement)
+            hash ^= ZOBRIST_KEYS.white_made_last_movement;
+    }
+
+    return hash;
+}
+
+CanonicalBoardState BoardState::get_canonical() const {
+    auto result = CanonicalBoardState{*this, Symmetry::identity(), this->get_hash()};
+
+    for (const auto symmetry : Symmetry::All) {
+        if (symmetry == Symmetry::identity())
+            continue;
+
+        auto board_state = this->transformed(symmetry);
+        const auto hash = board_state.get_hash();
+
+        if (hash < result.hash) {
+            result = CanonicalBoardState{std::move(board_state), symmetry, hash};
+        }
+    }
+
+    return result;
+}
+
+void BoardState::remove_row(HVec2 from, HVec2 to) {
+    const auto diff = HVec3{to - from};
+    const auto dir = diff / diff.length();
+
+    assert(diff.length() == 4);
+
+    auto current = from;
+    while (current != (to + dir)) {
+        assert(
+            this->storage.get_at(current) == Node::WhiteMarker ||
+            this->storage.get_at(current) == Node::BlackMarker
+        );
+        this->set_at(current, Node::Empty);
+
+        current += dir;
+    }
+
+    this->next_action = NextAction::RingRemoval;
+}
+
+void BoardState::check_for_rows_and_change_state() {
+    // The row was formed of the same color as the player who originally moved
+    const bool found_row_of_the_mover =
+        (this->white_moves_next ? this->white_row_count : this->black_row_count) > 0;
+    const bool found_rows = this->white_row_count + this->black_row_count > 0;
+
+    if (found_rows) {
+        this->next_action = NextAction::RowRemoval;
+
+        if (!found_row_of_the_mover) {
+            this->white_moves_next = !this->white_moves_next;
+        }
+    }
+    else {
+        this->next_action = NextAction::RingMovement;
+        this->white_moves_next = !this->white_made_last_movement;
+    }
+}
+
+void BoardState::remove_ring(HVec2 pos) {
+    this->set_at(pos, Node::Empty);
+
+    if (this->white_moves_next) {
+        this->white_rings_on_board--;
+    } else {
+        this->black_rings_on_board--;
+    }
+
+    if (this->white_rings_on_board == 2 ||
+        this->black_rings_on_board == 2) {
+        this->next_action = NextAction::GameOver;
+    } else {
+        check_for_rows_and_change_state();
+    }
+}
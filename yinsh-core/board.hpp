@@ -0,0 +1,168 @@
+#ifndef YINSH_CORE_BOARD_HPP
+#define YINSH_CORE_BOARD_HPP
+
+#include <yinsh-core/coords.hpp>
+
+#include <yngine/moves.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+enum class Node : uint8_t {
+    NotInGame = 0,
+
+    Empty,
+
+    WhiteRing,
+    BlackRing,
+
+    WhiteMarker,
+    BlackMarker,
+};
+
+class BoardStorage {
+public:
+    // Initialzes an empty board with correct NotInGame nodes
+    BoardStorage();
+
+    Node& at(int32_t x, int32_t y);
+    Node& at(HVec2 pos);
+
+    Node get_at(int32_t x, int32_t y) const;
+    Node get_at(HVec2 pos) const;
+
+private:
+    std::array<Node, 11*11> nodes;
+};
+
+// These offsets tell us where the board begins and ends relative to
+// a parallelogram that encloses the board
+inline const int32_t BOARD_START_OFFSET[11] = {
+    6, 4, 3, 2, 1, 1, 0, 0, 0, 0, 1
+};
+
+inline const int32_t BOARD_END_OFFSET[11] = {
+    9, 10, 10, 10, 10, 9, 9, 8, 7, 6, 4
+};
+
+// Windows of five nodes along the SE, NE and S axes that fit on the board,
+// every row of markers covers at least one of them
+inline constexpr int ROW_WINDOW_COUNT = 123;
+
+struct CanonicalBoardState;
+
+class BoardState {
+public:
+    enum class NextAction {
+        RingPlacement,
+        RingMovement,
+        RowRemoval,
+        RingRemoval,
+        GameOver,
+    };
+
+    enum class GameResult {
+        WhiteWon,
+        BlackWon,
+        Draw,
+    };
+
+    NextAction get_next_action() const;
+
+    // Should only be called when the game is over
+    GameResult get_game_result() const;
+
+    bool is_in_game(HVec2 pos) const;
+    Node get_at(HVec2 pos) const;
+    bool is_whites_move() const;
+
+    bool ring_moves_available() const;
+
+    bool is_move_legal(Yngine::Move move) const;
+    void apply_move(Yngine::Move move);
+
+    std::vector<HVec2> get_ring_moves(HVec2 pos) const;
+
+    // Rows are only returned in the SE, NE and S directions
+    // to avoid returning the same row twice
+    std::vector<Yngine::Move> get_legal_moves() const;
+
+    // Every window of five markers of one color on the whole board, a line of
+    // more than five markers gives several overlapping windows. Like in
+    // get_legal_moves only the SE, NE and S directions are returned
+    std::vector<Yngine::RemoveRowMove> get_rows(bool white) const;
+
+    // Same position seen through one of the symmetries of the board
+    BoardState transformed(Symmetry symmetry) const;
+
+    // Zobrist hash of everything that affects the rest of the game,
+    // the part for the pieces is updated with every change of the board
+    uint64_t get_hash() const;
+
+    // Picks the same orientation for all 12 symmetric variants of the position,
+    // so that caches and datasets only need one entry for all of them
+    CanonicalBoardState get_canonical() const;
+
+private:
+    // Restores positions from stored cell changes and states
+    friend class GameTimeline;
+
+    // Everything except the board itself
+    struct State {
+        NextAction next_action;
+        bool white_moves_next;
+        bool white_made_last_movement;
+        int white_rings_on_board;
+        int black_rings_on_board;
+    };
+
+    State get_state() const;
+    void set_state(const State& state);
+
+    // All changes of the board go through here to keep the hash
+    // and the marker counters up to date
+    void set_at(HVec2 pos, Node piece);
+    void clear_board();
+
+    void place_ring(HVec2 pos);
+    void move_ring(HVec2 from, HVec2 to);
+    void remove_row(HVec2 from, HVec2 to);
+    void remove_ring(HVec2 pos);
+
+    // Rows are removed before the next ring movement, so all rows on
+    // the board were formed by the last one
+    void check_for_rows_and_change_state();
+
+    BoardStorage storage;
+    uint64_t pieces_hash = 0;
+
+    // Markers of each color in every row window, a window is a row when it
+    // has five. Changing a node only touches the windows that contain it
+    std::array<uint8_t, ROW_WINDOW_COUNT> white_window_markers{};
+    std::array<uint8_t, ROW_WINDOW_COUNT> black_window_markers{};
+    int white_row_count = 0;
+    int black_row_count = 0;
+    int marker_count = 0;
+
+    NextAction next_action = NextAction::RingPlacement;
+    bool white_moves_next = true;
+
+    // Used when removing rings, to find the correct player to move next
+    bool white_made_last_movement = false;
+
+    int white_rings_on_board = 0;
+    int black_rings_on_board = 0;
+};
+
+struct CanonicalBoardState {
+    BoardState board_state;
+
+    // Maps the original position onto the canonical one, use
+    // its inverse to bring moves found in the canonical position back
+    Symmetry symmetry;
+
+    uint64_t hash;
+};
+
+#endif // YINSH_CORE_BOARD_HPP
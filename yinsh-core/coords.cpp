@@ -1,4 +1,7 @@
-#include <yinsh-gui/coords.hpp>
+#include <yinsh-core/coords.hpp>
+#include <yinsh-core/utils.hpp>
+
+#include <yngine/bitboard.hpp>
 
 #include <cmath>
 #include <numbers>
@@ -225,3 +228,81 @@ Yngine::Direction HVec3::direction_to(HVec3 to) const {
 
     abort();
 }
+
+const std::array<Symmetry, 12> Symmetry::All = {
+    Symmetry{false, 0}, Symmetry{false, 1}, Symmetry{false, 2},
+    Symmetry{false, 3}, Symmetry{false, 4}, Symmetry{false, 5},
+    Symmetry{true, 0}, Symmetry{true, 1}, Symmetry{true, 2},
+    Symmetry{true, 3}, Symmetry{true, 4}, Symmetry{true, 5},
+};
+
+Symmetry Symmetry::identity() {
+    return Symmetry{false, 0};
+}
+
+Symmetry Symmetry::inverse() const {
+    // A reflection is its own inverse, and a rotation following it
+    // is reversed by the reflection
+    if (this->reflection)
+        return *this;
+
+    return Symmetry{false, (6 - this->rotation) % 6};
+}
+
+bool Symmetry::operator==(const Symmetry rhs) const {
+    return this->reflection == rhs.reflection && this->rotation == rhs.rotation;
+}
+
+HVec3 Symmetry::apply_to_vector(HVec3 vec) const {
+    if (this->reflection) {
+        vec = HVec3{vec.y, vec.x, vec.z};
+    }
+
+    for (int32_t i = 0; i < this->rotation; i++) {
+        vec = HVec3{-vec.z, -vec.x, -vec.y};
+    }
+
+    return vec;
+}
+
+HVec2 Symmetry::apply(HVec2 pos) const {
+    const auto center = HVec2{5, 5};
+    return center + HVec2{this->apply_to_vector(HVec3{pos - center})};
+}
+
+Yngine::Direction Symmetry::apply(Yngine::Direction direction) const {
+    const auto dir = this->apply_to_vector(HVec3{HVec2::from_direction(direction)});
+    return HVec3{HVec2{0, 0}}.direction_to(dir);
+}
+
+Yngine::Move Symmetry::apply(Yngine::Move move) const {
+    const auto apply_to_index = [this](auto index) {
+        const auto pos = this->apply(to_hvector2(Yngine::Bitboard::index_to_coords(index)));
+        return Yngine::Bitboard::coords_to_index(pos.x, pos.y);
+    };
+
+    return std::visit(variant_overloaded{
+        [&](Yngine::PlaceRingMove move) -> Yngine::Move {
+            return Yngine::PlaceRingMove{apply_to_index(move.index)};
+        },
+        [&](Yngine::RingMove move) -> Yngine::Move {
+            return Yngine::RingMove{
+                apply_to_index(move.from),
+                apply_to_index(move.to),
+                this->apply(move.direction)
+            };
+        },
+        [&](Yngine::RemoveRowMove move) -> Yngine::Move {
+            return Yngine::RemoveRowMove{
+                apply_to_index(move.from),
+                this->apply(move.direction)
+            };
+        },
+        [&](Yngine::RemoveRingMove move) -> Yngine::Move {
+            return Yngine::RemoveRingMove{apply_to_index(move.index)};
+        },
+        [&](Yngine::PassMove move) -> Yngine::Move {
+            return move;
+        },
+    }, move);
+}
@@ -1,8 +1,10 @@
-#ifndef YINSH_GUI_COORDS_HPP
-#define YINSH_GUI_COORDS_HPP
+#ifndef YINSH_CORE_COORDS_HPP
+#define YINSH_CORE_COORDS_HPP
 
 #include <yngine/common.hpp>
+#include <yngine/moves.hpp>
 
+#include <array>
 #include <cstdint>
 #include <vector>
 
@@ -64,4 +66,26 @@ struct HVec3 {
     Yngine::Direction direction_to(HVec3 to) const;
 };
 
-#endif // YINSH_GUI_COORDS_HPP
+// One of the 12 symmetries of the board: an optional reflection
+// followed by a rotation by a multiple of 60 degrees around the center
+struct Symmetry {
+    bool reflection;
+    int32_t rotation;
+
+    const static std::array<Symmetry, 12> All;
+
+    static Symmetry identity();
+
+    Symmetry inverse() const;
+    bool operator==(const Symmetry rhs) const;
+
+    HVec2 apply(HVec2 pos) const;
+    Yngine::Direction apply(Yngine::Direction direction) const;
+    Yngine::Move apply(Yngine::Move move) const;
+
+private:
+    // Transforms a vector relative to the center
+    HVec3 apply_to_vector(HVec3 vec) const;
+};
+
+#endif // YINSH_CORE_COORDS_HPP
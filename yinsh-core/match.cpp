@@ -0,0 +1,145 @@
+#include <yinsh-core/match.hpp>
+#include <yinsh-core/notation.hpp>
+
+#include <yngine/mcts.hpp>
+
+#include <future>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+
+namespace {
+
+// Searches with the parallel scheme of the settings
+class MatchEngine {
+public:
+    explicit MatchEngine(const EngineSettings& settings) : settings{settings} {
+        const int engine_count =
+            settings.scheme == ParallelScheme::Root ? settings.thread_count : 1;
+
+        for (int i = 0; i < engine_count; i++) {
+            this->engines.push_back(
+                std::make_unique<Yngine::MCTS>(settings.memory_limit / engine_count)
+            );
+        }
+    }
+
+    void apply_move(Yngine::Move move) {
+        for (auto& engine : this->engines) {
+            engine->apply_move(move);
+        }
+    }
+
+    Yngine::Move search() {
+        if (this->settings.scheme == ParallelScheme::Tree) {
+            return this->engines.front()->search(this->settings.move_time, this->settings.thread_count).get();
+        }
+
+        // All engines search at the same time
+        std::vector<std::future<Yngine::Move>> searches{};
+        for (auto& engine : this->engines) {
+            searches.push_back(engine->search(this->settings.move_time, 1));
+        }
+
+        // Ties go to the move that reached the count first
+        std::map<std::string, int> votes{};
+        std::optional<Yngine::Move> best_move{};
+        int best_votes = 0;
+
+        for (auto& search : searches) {
+            const auto move = search.get();
+            const auto move_votes = ++votes[move_to_string(move)];
+
+            if (move_votes > best_votes) {
+                best_move = move;
+                best_votes = move_votes;
+            }
+        }
+
+        return *best_move;
+    }
+
+private:
+    EngineSettings settings;
+    std::vector<std::unique_ptr<Yngine::MCTS>> engines;
+};
+
+}
+
+std::vector<std::vector<Yngine::Move>> generate_reference_positions(int count, uint32_t seed) {
+    std::vector<std::vector<Yngine::Move>> result{};
+
+    // The distributions of the standard library differ between implementations,
+    // so the moves are picked with a plain modulo to get the same positions everywhere
+    std::mt19937 random{seed};
+
+    for (int i = 0; i < count; i++) {
+        BoardState board_state{};
+        std::vector<Yngine::Move> moves{};
+
+        // All rings are placed, then a few rings are moved
+        const int ply_count = 10 + 2 * (i % 4);
+
+        while (board_state.get_next_action() != BoardState::NextAction::GameOver) {
+            if (static_cast<int>(moves.size()) >= ply_count &&
+                board_state.get_next_action() == BoardState::NextAction::RingMovement) {
+                break;
+            }
+
+            const auto legal_moves = board_state.get_legal_moves();
+            const auto move = legal_moves[random() % legal_moves.size()];
+
+            board_state.apply_move(move);
+            moves.push_back(move);
+        }
+
+        result.push_back(std::move(moves));
+    }
+
+    return result;
+}
+
+GameRecord play_game(
+    const std::vector<Yngine::Move>& opening,
+    const EngineSettings& white,
+    const EngineSettings& black
+) {
+    BoardState board_state{};
+    MatchEngine white_engine{white};
+    MatchEngine black_engine{black};
+
+    GameRecord record{};
+
+    const auto apply_move = [&](Yngine::Move move) {
+        record.moves.push_back(move);
+        board_state.apply_move(move);
+        white_engine.apply_move(move);
+        black_engine.apply_move(move);
+    };
+
+    for (const auto move : opening) {
+        apply_move(move);
+    }
+
+    while (board_state.get_next_action() != BoardState::NextAction::GameOver) {
+        const bool is_whites_move = board_state.is_whites_move();
+
+        auto& engine = is_whites_move ? white_engine : black_engine;
+
+        const auto move = engine.search();
+
+        if (!board_state.is_move_legal(move)) {
+            // Shouldn't happen, but a broken engine loses the game
+            record.result = is_whites_move ?
+                BoardState::GameResult::BlackWon : BoardState::GameResult::WhiteWon;
+            return record;
+        }
+
+        apply_move(move);
+    }
+
+    record.result = board_state.get_game_result();
+    return record;
+}
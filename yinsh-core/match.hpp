@@ -0,0 +1,45 @@
+#ifndef YINSH_CORE_MATCH_HPP
+#define YINSH_CORE_MATCH_HPP
+
+#include <yinsh-core/board.hpp>
+
+#include <yngine/moves.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class ParallelScheme {
+    // One engine whose threads share a single tree
+    Tree,
+    // One engine with one thread for every thread, each grows its own tree
+    // in a share of the memory and the moves they choose are merged by vote
+    Root,
+};
+
+struct EngineSettings {
+    int thread_count;
+    float move_time;
+    std::size_t memory_limit;
+    ParallelScheme scheme = ParallelScheme::Tree;
+};
+
+// Positions reached from the start with random moves. The generator is seeded
+// so every machine gets the same positions for the same seed, each position is
+// given by the moves leading to it
+std::vector<std::vector<Yngine::Move>> generate_reference_positions(int count, uint32_t seed);
+
+struct GameRecord {
+    // All moves of the game including the opening
+    std::vector<Yngine::Move> moves;
+    BoardState::GameResult result;
+};
+
+// Plays the game to the end between two engines starting after the opening moves
+GameRecord play_game(
+    const std::vector<Yngine::Move>& opening,
+    const EngineSettings& white,
+    const EngineSettings& black
+);
+
+#endif // YINSH_CORE_MATCH_HPP
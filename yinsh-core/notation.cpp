@@ -0,0 +1,141 @@
+#include <yinsh-core/notation.hpp>
+
+#include <yinsh-core/coords.hpp>
+#include <yinsh-core/utils.hpp>
+
+#include <yngine/bitboard.hpp>
+
+#include <array>
+#include <sstream>
+#include <string_view>
+
+namespace {
+
+const std::array<std::pair<Yngine::Direction, std::string_view>, 6> DIRECTION_NAMES = {{
+    {Yngine::Direction::SE, "SE"},
+    {Yngine::Direction::NE, "NE"},
+    {Yngine::Direction::N, "N"},
+    {Yngine::Direction::NW, "NW"},
+    {Yngine::Direction::SW, "SW"},
+    {Yngine::Direction::S, "S"},
+}};
+
+std::string_view direction_to_string(Yngine::Direction direction) {
+    for (const auto& [dir, name] : DIRECTION_NAMES) {
+        if (dir == direction)
+            return name;
+    }
+
+    abort();
+}
+
+std::optional<Yngine::Direction> parse_direction(std::string_view name) {
+    for (const auto& [dir, dir_name] : DIRECTION_NAMES) {
+        if (dir_name == name)
+            return dir;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<HVec2> parse_position(std::istream& stream) {
+    int32_t x, y;
+    if (!(stream >> x >> y))
+        return std::nullopt;
+
+    if (x < 0 || y < 0 || x >= 11 || y >= 11)
+        return std::nullopt;
+
+    return HVec2{x, y};
+}
+
+HVec2 index_to_position(int index) {
+    return to_hvector2(Yngine::Bitboard::index_to_coords(index));
+}
+
+auto position_to_index(HVec2 pos) {
+    return Yngine::Bitboard::coords_to_index(pos.x, pos.y);
+}
+
+}
+
+std::string move_to_string(Yngine::Move move) {
+    std::ostringstream result;
+
+    std::visit(variant_overloaded{
+        [&result](Yngine::PlaceRingMove move) {
+            const auto pos = index_to_position(move.index);
+            result << "place " << pos.x << ' ' << pos.y;
+        },
+        [&result](Yngine::RingMove move) {
+            const auto from = index_to_position(move.from);
+            const auto to = index_to_position(move.to);
+            result << "move " << from.x << ' ' << from.y << ' ' << to.x << ' ' << to.y;
+        },
+        [&result](Yngine::RemoveRowMove move) {
+            const auto from = index_to_position(move.from);
+            result << "row " << from.x << ' ' << from.y << ' ' << direction_to_string(move.direction);
+        },
+        [&result](Yngine::RemoveRingMove move) {
+            const auto pos = index_to_position(move.index);
+            result << "ring " << pos.x << ' ' << pos.y;
+        },
+        [&result](Yngine::PassMove move) {
+            result << "pass";
+        },
+    }, move);
+
+    return result.str();
+}
+
+std::optional<Yngine::Move> parse_move(std::istream& stream) {
+    std::string kind;
+    if (!(stream >> kind))
+        return std::nullopt;
+
+    if (kind == "place") {
+        const auto pos = parse_position(stream);
+        if (!pos)
+            return std::nullopt;
+
+        return Yngine::PlaceRingMove{position_to_index(*pos)};
+    } else if (kind == "move") {
+        const auto from = parse_position(stream);
+        const auto to = parse_position(stream);
+        if (!from || !to)
+            return std::nullopt;
+
+        // Rings can only move along one of the three axes
+        const auto diff = HVec3{*to - *from};
+        if (diff.length() == 0 || (diff.x != 0 && diff.y != 0 && diff.z != 0))
+            return std::nullopt;
+
+        return Yngine::RingMove{
+            position_to_index(*from),
+            position_to_index(*to),
+            HVec3{*from}.direction_to(*to)
+        };
+    } else if (kind == "row") {
+        const auto from = parse_position(stream);
+
+        std::string direction_name;
+        if (!from || !(stream >> direction_name))
+            return std::nullopt;
+
+        const auto direction = parse_direction(direction_name);
+        if (!direction)
+            return std::nullopt;
+
+        return Yngine::RemoveRowMove{position_to_index(*from), *direction};
+    } else if (kind == "ring") {
+        const auto pos = parse_position(stream);
+        if (!pos)
+            return std::nullopt;
+
+        return Yngine::RemoveRingMove{position_to_index(*pos)};
+    } else if (kind == "pass") {
+        return Yngine::PassMove{};
+    }
+
+    return std::nullopt;
+}
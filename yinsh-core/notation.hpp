@@ -0,0 +1,21 @@
+#ifndef YINSH_CORE_NOTATION_HPP
+#define YINSH_CORE_NOTATION_HPP
+
+#include <yngine/moves.hpp>
+
+#include <istream>
+#include <optional>
+#include <string>
+
+// Moves are written with the same coordinates BoardState uses:
+//   place <x> <y>
+//   move <from x> <from y> <to x> <to y>
+//   row <x> <y> <direction>   (direction is one of SE, NE, N, NW, SW, S)
+//   ring <x> <y>
+//   pass
+std::string move_to_string(Yngine::Move move);
+
+// Returns nothing if the stream does not contain a well formed move
+std::optional<Yngine::Move> parse_move(std::istream& stream);
+
+#endif // YINSH_CORE_NOTATION_HPP
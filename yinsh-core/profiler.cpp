@@ -0,0 +1,214 @@
+#include <yinsh-core/profiler.hpp>
+
+#if defined(YINSH_PROFILING)
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Event {
+    const char* name;
+    uint64_t timestamp;
+    uint64_t duration;
+    uint64_t id;
+    Profiler::EventKind kind;
+};
+
+// The owning thread may overwrite a slot while the trace copies it, so every slot
+// is a seqlock: its sequence is odd during a write and 2 * (event index + 1) after it
+struct EventSlot {
+    std::atomic<uint64_t> sequence{0};
+
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> timestamp{0};
+    std::atomic<uint64_t> duration{0};
+    std::atomic<uint64_t> id{0};
+    std::atomic<Profiler::EventKind> kind{Profiler::EventKind::Instant};
+};
+
+struct ThreadBuffer {
+    static constexpr std::size_t CAPACITY = 1 << 16;
+
+    explicit ThreadBuffer(int thread_id) : thread_id{thread_id}, next_event{0}, events{} {}
+
+    int thread_id;
+
+    // Only the owning thread writes, readers see the events before this index
+    std::atomic<uint64_t> next_event;
+    std::array<EventSlot, CAPACITY> events;
+};
+
+void write_event(EventSlot& slot, uint64_t index, const Event& event) {
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.name.store(event.name, std::memory_order_relaxed);
+    slot.timestamp.store(event.timestamp, std::memory_order_relaxed);
+    slot.duration.store(event.duration, std::memory_order_relaxed);
+    slot.id.store(event.id, std::memory_order_relaxed);
+    slot.kind.store(event.kind, std::memory_order_relaxed);
+
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+// Fails if the slot doesn't hold the event with this index or was overwritten during the copy
+bool read_event(const EventSlot& slot, uint64_t index, Event& event) {
+    if (slot.sequence.load(std::memory_order_acquire) != 2 * index + 2)
+        return false;
+
+    event = Event{
+        slot.name.load(std::memory_order_relaxed),
+        slot.timestamp.load(std::memory_order_relaxed),
+        slot.duration.load(std::memory_order_relaxed),
+        slot.id.load(std::memory_order_relaxed),
+        slot.kind.load(std::memory_order_relaxed),
+    };
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == 2 * index + 2;
+}
+
+const auto PROGRAM_START = std::chrono::steady_clock::now();
+
+// Buffers outlive their threads so that events of finished threads still get
+// written. The buffer of a finished thread is handed to the next new thread,
+// which overwrites its oldest events, so there are only as many buffers as
+// threads that ever recorded at the same time
+std::mutex buffers_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+std::vector<ThreadBuffer*> free_buffers;
+
+// Returns the buffer to the free list when its thread exits
+class BufferLease {
+public:
+    BufferLease() {
+        std::lock_guard lock{buffers_mutex};
+
+        if (!free_buffers.empty()) {
+            this->buffer = free_buffers.back();
+            free_buffers.pop_back();
+        } else {
+            const auto thread_id = static_cast<int>(buffers.size());
+            buffers.push_back(std::make_unique<ThreadBuffer>(thread_id));
+
+            this->buffer = buffers.back().get();
+        }
+    }
+
+    ~BufferLease() {
+        std::lock_guard lock{buffers_mutex};
+        free_buffers.push_back(this->buffer);
+    }
+
+    BufferLease(const BufferLease&) = delete;
+    BufferLease& operator=(const BufferLease&) = delete;
+
+    ThreadBuffer* buffer;
+};
+
+ThreadBuffer& get_thread_buffer() {
+    thread_local BufferLease lease{};
+    return *lease.buffer;
+}
+
+const char* event_phase(Profiler::EventKind kind) {
+    switch (kind) {
+    case Profiler::EventKind::Complete:
+        return "X";
+    case Profiler::EventKind::Instant:
+        return "i";
+    case Profiler::EventKind::AsyncBegin:
+        return "b";
+    case Profiler::EventKind::AsyncEnd:
+        return "e";
+    default:
+        abort();
+    }
+}
+
+}
+
+uint64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - PROGRAM_START
+    ).count();
+}
+
+void Profiler::record(
+    const char* name,
+    EventKind kind,
+    uint64_t timestamp,
+    uint64_t duration,
+    uint64_t id
+) {
+    auto& buffer = get_thread_buffer();
+
+    const auto index = buffer.next_event.load(std::memory_order_relaxed);
+    write_event(buffer.events[index % ThreadBuffer::CAPACITY], index, Event{name, timestamp, duration, id, kind});
+    buffer.next_event.store(index + 1, std::memory_order_release);
+}
+
+bool Profiler::write_chrome_trace(const std::filesystem::path& path) {
+    std::ofstream file{path};
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[\n";
+
+    bool first_event = true;
+
+    std::lock_guard lock{buffers_mutex};
+    for (const auto& buffer : buffers) {
+        const auto end = buffer->next_event.load(std::memory_order_acquire);
+        const auto begin = end > ThreadBuffer::CAPACITY ? end - ThreadBuffer::CAPACITY : 0;
+
+        for (auto i = begin; i < end; i++) {
+            Event event;
+            if (!read_event(buffer->events[i % ThreadBuffer::CAPACITY], i, event))
+                continue;
+
+            if (!first_event)
+                file << ",\n";
+            first_event = false;
+
+            // Chrome expects microseconds
+            file << "{\"name\":\"" << event.name << "\""
+                 << ",\"ph\":\"" << event_phase(event.kind) << "\""
+                 << ",\"ts\":" << event.timestamp / 1000.0
+                 << ",\"pid\":1,\"tid\":" << buffer->thread_id;
+
+            switch (event.kind) {
+            case EventKind::Complete:
+                file << ",\"dur\":" << event.duration / 1000.0;
+                break;
+            case EventKind::Instant:
+                file << ",\"s\":\"t\"";
+                break;
+            case EventKind::AsyncBegin:
+            case EventKind::AsyncEnd:
+                file << ",\"cat\":\"async\",\"id\":" << event.id;
+                break;
+            }
+
+            file << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
+
+ProfileScope::ProfileScope(const char* name) : name{name}, start{Profiler::now()} {}
+
+ProfileScope::~ProfileScope() {
+    const auto end = Profiler::now();
+    Profiler::record(this->name, Profiler::EventKind::Complete, this->start, end - this->start);
+}
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef YINSH_CORE_PROFILER_HPP
+#define YINSH_CORE_PROFILER_HPP
+
+// Timing probes that are compiled in only with the YINSH_PROFILING option,
+// otherwise the macros expand to nothing
+#if defined(YINSH_PROFILING)
+
+#include <cstdint>
+#include <filesystem>
+
+class Profiler {
+public:
+    enum class EventKind : uint8_t {
+        Complete,
+        Instant,
+        AsyncBegin,
+        AsyncEnd,
+    };
+
+    // Nanoseconds since the start of the program
+    static uint64_t now();
+
+    // Every thread writes to its own ring buffer without locking, the oldest
+    // events are overwritten when it's full. Names must be string literals
+    static void record(
+        const char* name,
+        EventKind kind,
+        uint64_t timestamp,
+        uint64_t duration = 0,
+        uint64_t id = 0
+    );
+
+    // Events that are overwritten while the trace is being written are skipped
+    static bool write_chrome_trace(const std::filesystem::path& path);
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define YINSH_PROFILE_CONCAT_IMPL(a, b) a##b
+#define YINSH_PROFILE_CONCAT(a, b) YINSH_PROFILE_CONCAT_IMPL(a, b)
+
+#define YINSH_PROFILE_SCOPE(name) \
+    ProfileScope YINSH_PROFILE_CONCAT(profile_scope_, __LINE__){name}
+
+#define YINSH_PROFILE_INSTANT(name) \
+    Profiler::record(name, Profiler::EventKind::Instant, Profiler::now())
+
+// For spans that start and end in different scopes, e.g. a search
+#define YINSH_PROFILE_ASYNC_BEGIN(name, id) \
+    Profiler::record(name, Profiler::EventKind::AsyncBegin, Profiler::now(), 0, id)
+#define YINSH_PROFILE_ASYNC_END(name, id) \
+    Profiler::record(name, Profiler::EventKind::AsyncEnd, Profiler::now(), 0, id)
+
+#else
+
+#define YINSH_PROFILE_SCOPE(name) ((void)0)
+#define YINSH_PROFILE_INSTANT(name) ((void)0)
+#define YINSH_PROFILE_ASYNC_BEGIN(name, id) ((void)0)
+#define YINSH_PROFILE_ASYNC_END(name, id) ((void)0)
+
+#endif
+
+#endif // YINSH_CORE_PROFILER_HPP
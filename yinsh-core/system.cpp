@@ -0,0 +1,146 @@
+#include <yinsh-core/system.hpp>
+
+#if defined(__linux__)
+#include <sys/sysinfo.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#include <psapi.h>
+#elif defined(EMSCRIPTEN)
+#include <emscripten/heap.h>
+#include <emscripten/threading.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#if defined(__linux__)
+std::size_t get_system_memory() {
+    struct sysinfo system_info;
+    sysinfo(&system_info);
+
+    return system_info.totalram;
+}
+#elif defined(_WIN32)
+std::size_t get_system_memory() {
+    std::size_t total_memory;
+    GetPhysicallyInstalledSystemMemory(&total_memory);
+    return total_memory * 1024;
+}
+#elif defined(EMSCRIPTEN)
+std::size_t get_system_memory() {
+    // The heap may grow to 4GB, but browsers rarely let a tab commit that much,
+    // so only offer what a page can be expected to get
+    return std::min<std::size_t>(emscripten_get_heap_max(), 1536ull * 1024 * 1024);
+}
+#endif
+
+#if defined(__linux__)
+int get_system_threads() {
+    return get_nprocs();
+}
+#elif defined(_WIN32)
+int get_system_threads() {
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+
+    return system_info.dwNumberOfProcessors;
+}
+#elif defined(EMSCRIPTEN)
+int get_system_threads() {
+    return emscripten_num_logical_cores();
+}
+#endif
+
+#if defined(__linux__)
+// Reads a "Key: value kB" line from one of the files in /proc
+static std::optional<std::size_t> read_proc_kilobytes(const char* path, const std::string& key) {
+    std::ifstream file{path};
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.compare(0, key.size(), key) == 0) {
+            return std::stoull(line.substr(key.size())) * 1024;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::size_t> get_resident_memory() {
+    // The second field is the resident size in pages, the kernel doesn't
+    // have to walk the mappings of the process to fill it in
+    std::ifstream file{"/proc/self/statm"};
+
+    std::size_t total_pages, resident_pages;
+    if (!(file >> total_pages >> resident_pages))
+        return std::nullopt;
+
+    return resident_pages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+std::optional<ProcessMemory> get_process_memory() {
+    const auto resident = get_resident_memory();
+    if (!resident)
+        return std::nullopt;
+
+    return ProcessMemory{
+        *resident,
+        read_proc_kilobytes("/proc/self/smaps_rollup", "Pss:"),
+    };
+}
+#elif defined(_WIN32)
+std::optional<std::size_t> get_resident_memory() {
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return std::nullopt;
+
+    return counters.WorkingSetSize;
+}
+
+std::optional<ProcessMemory> get_process_memory() {
+    const auto resident = get_resident_memory();
+    if (!resident)
+        return std::nullopt;
+
+    return ProcessMemory{*resident, std::nullopt};
+}
+#elif defined(EMSCRIPTEN)
+std::optional<std::size_t> get_resident_memory() {
+    // The whole heap of the page is committed
+    return emscripten_get_heap_size();
+}
+
+std::optional<ProcessMemory> get_process_memory() {
+    return ProcessMemory{emscripten_get_heap_size(), std::nullopt};
+}
+#endif
+
+#if defined(__linux__)
+std::optional<std::filesystem::path> get_config_directory() {
+    if (const auto config_home = std::getenv("XDG_CONFIG_HOME"); config_home && *config_home) {
+        return std::filesystem::path{config_home} / "yinsh";
+    }
+
+    if (const auto home = std::getenv("HOME"); home && *home) {
+        return std::filesystem::path{home} / ".config" / "yinsh";
+    }
+
+    return std::nullopt;
+}
+#elif defined(_WIN32)
+std::optional<std::filesystem::path> get_config_directory() {
+    if (const auto app_data = std::getenv("APPDATA"); app_data && *app_data) {
+        return std::filesystem::path{app_data} / "yinsh";
+    }
+
+    return std::nullopt;
+}
+#elif defined(EMSCRIPTEN)
+std::optional<std::filesystem::path> get_config_directory() {
+    // Browsers don't give us a persistent file system
+    return std::nullopt;
+}
+#endif
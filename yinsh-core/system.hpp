@@ -0,0 +1,30 @@
+#ifndef YINSH_CORE_SYSTEM_HPP
+#define YINSH_CORE_SYSTEM_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+
+std::size_t get_system_memory();
+int get_system_threads();
+
+struct ProcessMemory {
+    // Memory of the process that is actually in RAM
+    std::size_t resident;
+
+    // Resident memory with pages shared with other processes divided between
+    // them, not every platform reports it
+    std::optional<std::size_t> proportional;
+};
+
+// The proportional memory is expensive to compute for a large process,
+// so this shouldn't be polled often, e.g. by the render loop
+std::optional<ProcessMemory> get_process_memory();
+
+// Only the resident memory, cheap enough to poll from the render loop
+std::optional<std::size_t> get_resident_memory();
+
+// Directory for the settings of the game, it might not exist yet
+std::optional<std::filesystem::path> get_config_directory();
+
+#endif // YINSH_CORE_SYSTEM_HPP
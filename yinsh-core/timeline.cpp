@@ -0,0 +1,63 @@
+#include <yinsh-core/timeline.hpp>
+
+#include <cassert>
+
+GameTimeline::GameTimeline()
+    : keyframes{BoardState{}}
+    , plies{}
+    , last_position{} {
+}
+
+void GameTimeline::push(Yngine::Move move, const BoardState& board_state) {
+    auto ply = Ply{move, {}, board_state.get_state()};
+
+    for (int32_t y = 0; y < 11; y++) {
+        for (int32_t x = 0; x < 11; x++) {
+            const auto pos = HVec2{x, y};
+
+            if (board_state.is_in_game(pos) &&
+                board_state.get_at(pos) != this->last_position.get_at(pos)) {
+                ply.changes.push_back(CellChange{
+                    static_cast<uint8_t>(11 * y + x),
+                    board_state.get_at(pos)
+                });
+            }
+        }
+    }
+
+    this->plies.push_back(std::move(ply));
+    this->last_position = board_state;
+
+    if (this->get_ply_count() % KEYFRAME_INTERVAL == 0) {
+        this->keyframes.push_back(board_state);
+    }
+}
+
+int GameTimeline::get_ply_count() const {
+    return static_cast<int>(this->plies.size());
+}
+
+BoardState GameTimeline::get_position(int ply) const {
+    assert(ply >= 0 && ply <= this->get_ply_count());
+
+    const auto keyframe = ply / KEYFRAME_INTERVAL;
+    auto result = this->keyframes[keyframe];
+
+    for (int i = keyframe * KEYFRAME_INTERVAL; i < ply; i++) {
+        const auto& delta = this->plies[i];
+
+        for (const auto change : delta.changes) {
+            result.set_at(HVec2{change.index % 11, change.index / 11}, change.piece);
+        }
+
+        result.set_state(delta.state);
+    }
+
+    return result;
+}
+
+Yngine::Move GameTimeline::get_move(int ply) const {
+    assert(ply >= 1 && ply <= this->get_ply_count());
+
+    return this->plies[ply - 1].move;
+}
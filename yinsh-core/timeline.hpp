@@ -0,0 +1,53 @@
+#ifndef YINSH_CORE_TIMELINE_HPP
+#define YINSH_CORE_TIMELINE_HPP
+
+#include <yinsh-core/board.hpp>
+
+#include <yngine/moves.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// History of a game that can bring back the position after any ply.
+// Every ply is stored as the cells the move changed and the rest of the state,
+// and every KEYFRAME_INTERVAL plies a full copy of the position is kept,
+// so seeking applies at most KEYFRAME_INTERVAL - 1 plies to a copy of a keyframe
+class GameTimeline {
+public:
+    static constexpr int KEYFRAME_INTERVAL = 16;
+
+    // Starts with the initial position
+    GameTimeline();
+
+    // Records the move and the position it led to
+    void push(Yngine::Move move, const BoardState& board_state);
+
+    // Number of moves played, the last position is at this ply
+    int get_ply_count() const;
+
+    // Ply zero is the initial position
+    BoardState get_position(int ply) const;
+
+    // Returns the move that led to the position at the ply
+    Yngine::Move get_move(int ply) const;
+
+private:
+    struct CellChange {
+        uint8_t index;
+        Node piece;
+    };
+
+    struct Ply {
+        Yngine::Move move;
+        std::vector<CellChange> changes;
+        BoardState::State state;
+    };
+
+    std::vector<BoardState> keyframes;
+    std::vector<Ply> plies;
+
+    // Position after the last ply, new plies are compared against it
+    BoardState last_position;
+};
+
+#endif // YINSH_CORE_TIMELINE_HPP
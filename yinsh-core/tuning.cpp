@@ -0,0 +1,53 @@
+#include <yinsh-core/tuning.hpp>
+#include <yinsh-core/system.hpp>
+
+#include <fstream>
+#include <string>
+
+static std::optional<std::filesystem::path> get_tuning_file_path() {
+    const auto config_directory = get_config_directory();
+    if (!config_directory)
+        return std::nullopt;
+
+    return *config_directory / "tuning.txt";
+}
+
+std::optional<int> load_tuned_thread_count() {
+    const auto path = get_tuning_file_path();
+    if (!path)
+        return std::nullopt;
+
+    std::ifstream file{*path};
+
+    std::string threads_key, system_threads_key;
+    int thread_count, system_threads;
+
+    if (!(file >> threads_key >> thread_count >> system_threads_key >> system_threads) ||
+        threads_key != "threads" || system_threads_key != "system-threads") {
+        return std::nullopt;
+    }
+
+    if (system_threads != get_system_threads() ||
+        thread_count < 1 || thread_count > system_threads) {
+        return std::nullopt;
+    }
+
+    return thread_count;
+}
+
+bool save_tuned_thread_count(int thread_count) {
+    const auto path = get_tuning_file_path();
+    if (!path)
+        return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(path->parent_path(), error);
+    if (error)
+        return false;
+
+    std::ofstream file{*path};
+    file << "threads " << thread_count << '\n';
+    file << "system-threads " << get_system_threads() << '\n';
+
+    return static_cast<bool>(file);
+}
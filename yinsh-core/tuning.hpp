@@ -0,0 +1,12 @@
+#ifndef YINSH_CORE_TUNING_HPP
+#define YINSH_CORE_TUNING_HPP
+
+#include <optional>
+
+// Thread count chosen by the thread scaling benchmark of Yinsh-bench.
+// It's stored together with the number of system threads and is ignored
+// if that number changes, e.g. when the config is copied to another machine
+std::optional<int> load_tuned_thread_count();
+bool save_tuned_thread_count(int thread_count);
+
+#endif // YINSH_CORE_TUNING_HPP
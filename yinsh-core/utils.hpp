@@ -0,0 +1,19 @@
+#ifndef YINSH_CORE_UTILS_HPP
+#define YINSH_CORE_UTILS_HPP
+
+#include <yinsh-core/coords.hpp>
+
+#include <yngine/common.hpp>
+
+template<class... Ts>
+struct variant_overloaded : Ts... { using Ts::operator()...; };
+
+inline HVec2 to_hvector2(Yngine::Vec2 vec) {
+    return HVec2{vec.first, vec.second};
+}
+
+inline Yngine::Vec2 from_hvector2(HVec2 vec) {
+    return std::make_pair(vec.x, vec.y);
+}
+
+#endif // YINSH_CORE_UTILS_HPP
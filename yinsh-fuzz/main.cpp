@@ -0,0 +1,512 @@
+#include <yinsh-fuzz/reference_board.hpp>
+#include <yinsh-core/board.hpp>
+#include <yinsh-core/notation.hpp>
+#include <yinsh-core/utils.hpp>
+
+#include <yngine/bitboard.hpp>
+#include <yngine/mcts.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+static void print_usage(const char* program) {
+    std::fprintf(
+        stderr,
+        "Usage: %s [--seconds S] [--threads N] [--seed N] [--full-every N] [--engine-every N] [--memory MB]\n"
+        "  --seconds       how long to play random games (default 60)\n"
+        "  --threads       threads that play games (default all cores)\n"
+        "  --seed          seed of the first thread, the others use the following ones (default 1)\n"
+        "  --full-every    the legal moves, rows and probes are compared every Nth ply, the\n"
+        "                  board and the player to move after every move (default 4)\n"
+        "  --engine-every  every Nth game of a thread is played by the engine, whose\n"
+        "                  moves must be legal, 0 never uses the engine (default 0)\n"
+        "  --memory        search tree memory of the engines (default 64)\n",
+        program
+    );
+}
+
+static bool parse_positive(std::string_view text, int& result) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result);
+    return error == std::errc{} && end == text.data() + text.size() && result > 0;
+}
+
+static bool parse_non_negative(std::string_view text, int& result) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result);
+    return error == std::errc{} && end == text.data() + text.size() && result >= 0;
+}
+
+static bool parse_positive(const char* text, float& result) {
+    char* end;
+    result = std::strtof(text, &end);
+    return end != text && *end == '\0' && result > 0;
+}
+
+// Short searches, the engine only has to produce moves and not good ones
+static constexpr float ENGINE_MOVE_TIME = 0.005f;
+
+// Random moves of every kind that each position is also asked about,
+// most of them are illegal
+static constexpr int PROBE_COUNT = 16;
+
+struct Boards {
+    BoardState board_state{};
+    ReferenceBoard reference{};
+};
+
+struct Mismatch {
+    // Moves that are needed to see the disagreement
+    std::size_t move_count;
+    std::string description;
+};
+
+// Moves are compared by these numbers, the strings are only built for the report
+static uint32_t move_key(Yngine::Move move) {
+    const auto fields = std::visit(variant_overloaded{
+        [](Yngine::PlaceRingMove move) { return std::array<int, 3>{move.index, 0, 0}; },
+        [](Yngine::RingMove move) { return std::array<int, 3>{move.from, move.to, 0}; },
+        [](Yngine::RemoveRowMove move) {
+            return std::array<int, 3>{move.from, 0, static_cast<int>(move.direction)};
+        },
+        [](Yngine::RemoveRingMove move) { return std::array<int, 3>{move.index, 0, 0}; },
+        [](Yngine::PassMove) { return std::array<int, 3>{0, 0, 0}; },
+    }, move);
+
+    return static_cast<uint32_t>(move.index()) << 24 |
+        static_cast<uint8_t>(fields[0]) << 16 |
+        static_cast<uint8_t>(fields[1]) << 8 |
+        static_cast<uint8_t>(fields[2]);
+}
+
+template<typename Moves>
+static std::vector<uint32_t> to_sorted_keys(const Moves& moves) {
+    std::vector<uint32_t> result{};
+    result.reserve(moves.size());
+
+    for (const auto move : moves) {
+        result.push_back(move_key(move));
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+template<typename Moves>
+static std::vector<std::string> to_sorted_strings(const Moves& moves) {
+    std::vector<std::string> result{};
+
+    for (const auto move : moves) {
+        result.push_back(move_to_string(move));
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+static std::string join(const std::vector<std::string>& strings) {
+    std::string result{};
+
+    for (const auto& string : strings) {
+        result += result.empty() ? "" : ", ";
+        result += string;
+    }
+
+    return result.empty() ? "none" : result;
+}
+
+template<typename Random>
+static Yngine::Move random_move(Random& random) {
+    const auto random_index = [&random] {
+        return Yngine::Bitboard::coords_to_index(random() % 11, random() % 11);
+    };
+    const auto random_direction = [&random] {
+        return static_cast<Yngine::Direction>(random() % 6);
+    };
+
+    switch (random() % 5) {
+    case 0:
+        return Yngine::PlaceRingMove{random_index()};
+    case 1:
+        return Yngine::RingMove{random_index(), random_index(), random_direction()};
+    case 2:
+        return Yngine::RemoveRowMove{random_index(), random_direction()};
+    case 3:
+        return Yngine::RemoveRingMove{random_index()};
+    default:
+        return Yngine::PassMove{};
+    }
+}
+
+// Describes the first difference between the boards and the players to move
+static std::optional<std::string> compare_boards(const Boards& boards) {
+    const auto& board_state = boards.board_state;
+    const auto& reference = boards.reference;
+
+    if (board_state.get_next_action() != reference.get_next_action()) {
+        return "next action " + std::to_string(static_cast<int>(board_state.get_next_action())) +
+            ", reference " + std::to_string(static_cast<int>(reference.get_next_action()));
+    }
+
+    if (board_state.is_whites_move() != reference.is_whites_move()) {
+        return std::string{"white moves next "} + (board_state.is_whites_move() ? "true" : "false") +
+            ", reference " + (reference.is_whites_move() ? "true" : "false");
+    }
+
+    for (int32_t y = 0; y < 11; y++) {
+        for (int32_t x = 0; x < 11; x++) {
+            const auto pos = HVec2{x, y};
+
+            if (board_state.is_in_game(pos) != reference.is_in_game(pos) ||
+                board_state.get_at(pos) != reference.get_at(pos)) {
+                return "node " + std::to_string(x) + ' ' + std::to_string(y) +
+                    " is " + std::to_string(static_cast<int>(board_state.get_at(pos))) +
+                    ", reference " + std::to_string(static_cast<int>(reference.get_at(pos)));
+            }
+        }
+    }
+
+    if (board_state.get_next_action() == BoardState::NextAction::GameOver &&
+        board_state.get_game_result() != reference.get_game_result()) {
+        return "game result " + std::to_string(static_cast<int>(board_state.get_game_result())) +
+            ", reference " + std::to_string(static_cast<int>(reference.get_game_result()));
+    }
+
+    return std::nullopt;
+}
+
+// Describes the first difference between the two positions, including
+// everything that the rules derive from them
+static std::optional<std::string> compare(const Boards& boards) {
+    if (const auto difference = compare_boards(boards))
+        return difference;
+
+    const auto& board_state = boards.board_state;
+    const auto& reference = boards.reference;
+
+    const auto legal_moves = board_state.get_legal_moves();
+    const auto reference_legal_moves = reference.get_legal_moves();
+    if (to_sorted_keys(legal_moves) != to_sorted_keys(reference_legal_moves)) {
+        return "legal moves " + join(to_sorted_strings(legal_moves)) +
+            "\nreference " + join(to_sorted_strings(reference_legal_moves));
+    }
+
+    for (const auto move : legal_moves) {
+        if (!board_state.is_move_legal(move)) {
+            return "the generated move " + move_to_string(move) + " is not legal";
+        }
+    }
+
+    for (const bool white : {true, false}) {
+        const auto rows = board_state.get_rows(white);
+        const auto reference_rows = reference.get_rows(white);
+
+        if (to_sorted_keys(rows) != to_sorted_keys(reference_rows)) {
+            return std::string{white ? "white" : "black"} + " rows " + join(to_sorted_strings(rows)) +
+                "\nreference " + join(to_sorted_strings(reference_rows));
+        }
+    }
+
+    // Seeded by the position so that a replay of the game asks the same questions,
+    // seeding a Mersenne Twister for every position would cost more than the probes
+    std::minstd_rand probe_random{static_cast<uint32_t>(board_state.get_hash())};
+    for (int i = 0; i < PROBE_COUNT; i++) {
+        const auto move = random_move(probe_random);
+
+        if (board_state.is_move_legal(move) != reference.is_move_legal(move)) {
+            return "legality of " + move_to_string(move) + " is " +
+                (board_state.is_move_legal(move) ? "true" : "false") + ", reference " +
+                (reference.is_move_legal(move) ? "true" : "false");
+        }
+    }
+
+    return std::nullopt;
+}
+
+// Plays the moves on both implementations and returns the first disagreement.
+// Moves that both of them reject are left out, so that removing moves from a game
+// still gives a game. The moves that were played are stored in `played`
+static std::optional<Mismatch> replay(const std::vector<Yngine::Move>& moves, std::vector<Yngine::Move>& played) {
+    Boards boards{};
+    played.clear();
+
+    for (std::size_t i = 0; i <= moves.size(); i++) {
+        if (const auto difference = compare(boards)) {
+            return Mismatch{played.size(), *difference};
+        }
+
+        if (i == moves.size())
+            break;
+
+        const auto move = moves[i];
+        const bool is_legal = boards.board_state.is_move_legal(move);
+
+        if (is_legal != boards.reference.is_move_legal(move)) {
+            played.push_back(move);
+
+            return Mismatch{
+                played.size(),
+                "legality of " + move_to_string(move) + " is " + (is_legal ? "true" : "false") +
+                    ", reference " + (is_legal ? "false" : "true")
+            };
+        }
+
+        if (!is_legal)
+            continue;
+
+        boards.board_state.apply_move(move);
+        boards.reference.apply_move(move);
+        played.push_back(move);
+    }
+
+    return std::nullopt;
+}
+
+// Removes as many moves as possible while the game still makes the
+// implementations disagree, with the chunks of delta debugging
+static std::vector<Yngine::Move> minimize(std::vector<Yngine::Move> moves, Mismatch& mismatch) {
+    moves.resize(mismatch.move_count);
+
+    std::vector<Yngine::Move> played{};
+
+    std::size_t chunk_count = 2;
+    while (moves.size() >= 2) {
+        const auto chunk_size = (moves.size() + chunk_count - 1) / chunk_count;
+        bool removed_chunk = false;
+
+        for (std::size_t start = 0; start < moves.size(); start += chunk_size) {
+            auto candidate = moves;
+            candidate.erase(
+                candidate.begin() + start,
+                candidate.begin() + std::min(start + chunk_size, candidate.size())
+            );
+
+            const auto candidate_mismatch = replay(candidate, played);
+            if (!candidate_mismatch)
+                continue;
+
+            moves = played;
+            mismatch = *candidate_mismatch;
+
+            chunk_count = std::max<std::size_t>(chunk_count - 1, 2);
+            removed_chunk = true;
+            break;
+        }
+
+        if (!removed_chunk) {
+            if (chunk_size == 1)
+                break;
+
+            chunk_count = std::min(chunk_count * 2, moves.size());
+        }
+    }
+
+    return moves;
+}
+
+struct Failure {
+    std::vector<Yngine::Move> moves;
+    std::string description;
+    // Engine games can't be replayed, the engine doesn't pick the same moves again
+    bool is_from_engine;
+};
+
+// Plays one game with random moves, or engine moves if an engine is given,
+// checking both implementations before every move. Everything is compared
+// every full_every plies and at the end, the board before the other moves.
+// A failure is replayed with full comparisons, which finds its first ply
+static std::optional<Failure> play_game(
+    std::mt19937& random,
+    Yngine::MCTS* engine,
+    int full_every,
+    std::size_t& ply_count
+) {
+    Boards boards{};
+    std::vector<Yngine::Move> moves{};
+
+    while (true) {
+        const bool is_full = moves.size() % full_every == 0 ||
+            boards.board_state.get_next_action() == BoardState::NextAction::GameOver;
+
+        if (const auto difference = is_full ? compare(boards) : compare_boards(boards)) {
+            return Failure{std::move(moves), *difference, engine != nullptr};
+        }
+
+        if (boards.board_state.get_next_action() == BoardState::NextAction::GameOver)
+            break;
+
+        Yngine::Move move;
+        if (engine) {
+            move = engine->search(ENGINE_MOVE_TIME, 1).get();
+        } else {
+            const auto legal_moves = boards.board_state.get_legal_moves();
+            move = legal_moves[random() % legal_moves.size()];
+        }
+
+        moves.push_back(move);
+
+        const bool is_legal = boards.board_state.is_move_legal(move);
+        if (!is_legal || !boards.reference.is_move_legal(move)) {
+            return Failure{
+                std::move(moves),
+                std::string{engine ? "the engine" : "BoardState"} + " chose the move " + move_to_string(move) +
+                    ", legal " + (is_legal ? "true" : "false") +
+                    ", reference " + (boards.reference.is_move_legal(move) ? "true" : "false"),
+                engine != nullptr
+            };
+        }
+
+        boards.board_state.apply_move(move);
+        boards.reference.apply_move(move);
+
+        if (engine) {
+            engine->apply_move(move);
+        }
+    }
+
+    ply_count = moves.size();
+    return std::nullopt;
+}
+
+int main(int argc, char** argv) {
+    float seconds = 60.f;
+    int thread_count = std::max(1u, std::thread::hardware_concurrency());
+    int seed = 1;
+    int full_every = 4;
+    int engine_every = 0;
+    int memory_limit_mb = 64;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view option = argv[i];
+
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        const char* value = argv[++i];
+
+        bool is_valid = true;
+        if (option == "--seconds") {
+            is_valid = parse_positive(value, seconds);
+        } else if (option == "--threads") {
+            is_valid = parse_positive(value, thread_count);
+        } else if (option == "--seed") {
+            is_valid = parse_positive(value, seed);
+        } else if (option == "--full-every") {
+            is_valid = parse_positive(value, full_every);
+        } else if (option == "--engine-every") {
+            is_valid = parse_non_negative(value, engine_every);
+        } else if (option == "--memory") {
+            is_valid = parse_positive(value, memory_limit_mb);
+        } else {
+            is_valid = false;
+        }
+
+        if (!is_valid) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::atomic<bool> should_stop = false;
+    std::atomic<long long> game_count = 0, total_ply_count = 0, engine_game_count = 0;
+
+    std::mutex failure_mutex;
+    std::optional<Failure> failure{};
+
+    std::vector<std::thread> threads{};
+    for (int thread_index = 0; thread_index < thread_count; thread_index++) {
+        threads.emplace_back([&, thread_index] {
+            std::mt19937 random{static_cast<uint32_t>(seed + thread_index)};
+
+            for (long long game = 1; !should_stop; game++) {
+                std::unique_ptr<Yngine::MCTS> engine{};
+                if (engine_every > 0 && game % engine_every == 0) {
+                    engine = std::make_unique<Yngine::MCTS>(
+                        static_cast<std::size_t>(memory_limit_mb) * 1024 * 1024
+                    );
+                }
+
+                std::size_t ply_count = 0;
+                auto game_failure = play_game(random, engine.get(), full_every, ply_count);
+
+                if (game_failure) {
+                    std::lock_guard lock{failure_mutex};
+                    if (!failure) {
+                        failure = std::move(game_failure);
+                    }
+
+                    should_stop = true;
+                    break;
+                }
+
+                game_count++;
+                total_ply_count += ply_count;
+                engine_game_count += engine != nullptr;
+            }
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::duration<float>(seconds);
+
+    while (!should_stop && std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        const auto elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        std::printf(
+            "\r%lld games, %lld by the engine, %.0f games/s, %.0f plies/s   ",
+            game_count.load(),
+            engine_game_count.load(),
+            game_count / elapsed,
+            total_ply_count / elapsed
+        );
+        std::fflush(stdout);
+    }
+
+    should_stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::printf("\n");
+
+    if (!failure) {
+        std::printf("BoardState and the reference rules agreed in every game\n");
+        return 0;
+    }
+
+    auto moves = std::move(failure->moves);
+    auto description = std::move(failure->description);
+
+    if (!failure->is_from_engine) {
+        std::vector<Yngine::Move> played{};
+        if (auto mismatch = replay(moves, played)) {
+            const auto original_size = moves.size();
+            moves = minimize(std::move(played), *mismatch);
+            description = mismatch->description;
+
+            std::printf("Minimized the game from %zu to %zu moves\n", original_size, moves.size());
+        }
+    }
+
+    std::printf("\nThe implementations disagree after these moves:\n");
+    for (const auto move : moves) {
+        std::printf("move %s\n", move_to_string(move).c_str());
+    }
+    std::printf("\n%s\n", description.c_str());
+
+    return 1;
+}
@@ -0,0 +1,360 @@
+#include <yinsh-fuzz/reference_board.hpp>
+#include <yinsh-core/utils.hpp>
+
+#include <yngine/bitboard.hpp>
+
+#include <cassert>
+#include <cstdlib>
+
+// Indexed by Yngine::Direction
+static const HVec2 DIRECTIONS[6] = {
+    HVec2{1, 0}, HVec2{0, 1}, HVec2{-1, 1},
+    HVec2{-1, 0}, HVec2{0, -1}, HVec2{1, -1},
+};
+
+static const Yngine::Direction ROW_DIRECTIONS[3] = {
+    Yngine::Direction::SE, Yngine::Direction::NE, Yngine::Direction::S,
+};
+
+static HVec2 index_to_pos(int8_t index) {
+    return to_hvector2(Yngine::Bitboard::index_to_coords(index));
+}
+
+static int8_t pos_to_index(HVec2 pos) {
+    return Yngine::Bitboard::coords_to_index(pos.x, pos.y);
+}
+
+static HVec2 direction_to_vector(Yngine::Direction direction) {
+    return DIRECTIONS[static_cast<int>(direction)];
+}
+
+ReferenceBoard::ReferenceBoard() {
+    // The board is a hexagon with sides of length 5 around (5, 5)
+    // without its six corners
+    for (int32_t x = 0; x < 11; x++) {
+        for (int32_t y = 0; y < 11; y++) {
+            const int32_t a = std::abs(x - 5), b = std::abs(y - 5), c = std::abs(x + y - 10);
+            const bool is_corner = (a == 5) + (b == 5) + (c == 5) == 2;
+
+            this->nodes[x][y] = a <= 5 && b <= 5 && c <= 5 && !is_corner ?
+                Node::Empty : Node::NotInGame;
+        }
+    }
+}
+
+ReferenceBoard::NextAction ReferenceBoard::get_next_action() const {
+    return this->next_action;
+}
+
+bool ReferenceBoard::is_whites_move() const {
+    return this->white_to_move;
+}
+
+ReferenceBoard::GameResult ReferenceBoard::get_game_result() const {
+    assert(this->next_action == NextAction::GameOver);
+
+    if (this->white_rings_removed > this->black_rings_removed)
+        return GameResult::WhiteWon;
+    if (this->black_rings_removed > this->white_rings_removed)
+        return GameResult::BlackWon;
+    return GameResult::Draw;
+}
+
+bool ReferenceBoard::is_in_game(HVec2 pos) const {
+    return pos.x >= 0 && pos.y >= 0 && pos.x < 11 && pos.y < 11 &&
+        this->nodes[pos.x][pos.y] != Node::NotInGame;
+}
+
+Node ReferenceBoard::get_at(HVec2 pos) const {
+    return this->nodes[pos.x][pos.y];
+}
+
+int ReferenceBoard::count(Node piece) const {
+    int result = 0;
+
+    for (int32_t x = 0; x < 11; x++) {
+        for (int32_t y = 0; y < 11; y++) {
+            result += this->nodes[x][y] == piece;
+        }
+    }
+
+    return result;
+}
+
+bool ReferenceBoard::is_row(HVec2 from, HVec2 dir, bool white) const {
+    const auto marker = white ? Node::WhiteMarker : Node::BlackMarker;
+
+    for (int32_t i = 0; i < 5; i++) {
+        const auto pos = from + dir * i;
+        if (!this->is_in_game(pos) || this->get_at(pos) != marker)
+            return false;
+    }
+
+    return true;
+}
+
+// A ring moves in a straight line over empty nodes, it may then jump over
+// a continuous group of markers and must stop on the first empty node after them
+bool ReferenceBoard::is_ring_move_legal(HVec2 from, HVec2 to) const {
+    const auto ring = this->white_to_move ? Node::WhiteRing : Node::BlackRing;
+
+    if (!this->is_in_game(from) || this->get_at(from) != ring)
+        return false;
+    if (!this->is_in_game(to) || this->get_at(to) != Node::Empty)
+        return false;
+
+    // Only the line that leads to the destination is walked
+    for (const auto dir : DIRECTIONS) {
+        bool is_on_line = false;
+        for (int32_t distance = 1; distance < 11; distance++) {
+            is_on_line = is_on_line || from + dir * distance == to;
+        }
+
+        if (!is_on_line)
+            continue;
+
+        bool jumped_markers = false;
+
+        for (auto pos = from + dir; this->is_in_game(pos); pos += dir) {
+            const auto piece = this->get_at(pos);
+
+            if (pos == to)
+                return true;
+
+            if (piece == Node::WhiteRing || piece == Node::BlackRing)
+                return false;
+
+            if (piece == Node::Empty && jumped_markers)
+                return false;
+
+            if (piece == Node::WhiteMarker || piece == Node::BlackMarker) {
+                jumped_markers = true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool ReferenceBoard::has_ring_moves() const {
+    const auto ring = this->white_to_move ? Node::WhiteRing : Node::BlackRing;
+
+    for (int32_t x = 0; x < 11; x++) {
+        for (int32_t y = 0; y < 11; y++) {
+            if (this->nodes[x][y] != ring)
+                continue;
+
+            for (const auto dir : DIRECTIONS) {
+                for (auto to = HVec2{x, y} + dir; this->is_in_game(to); to += dir) {
+                    if (this->is_ring_move_legal(HVec2{x, y}, to))
+                        return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool ReferenceBoard::is_move_legal(Yngine::Move move) const {
+    return std::visit(variant_overloaded{
+        [this](Yngine::PlaceRingMove move) {
+            const auto pos = index_to_pos(move.index);
+
+            return this->next_action == NextAction::RingPlacement &&
+                this->is_in_game(pos) && this->get_at(pos) == Node::Empty;
+        },
+        [this](Yngine::RingMove move) {
+            // BoardState ignores the direction of ring moves as well
+            return this->next_action == NextAction::RingMovement &&
+                this->is_ring_move_legal(index_to_pos(move.from), index_to_pos(move.to));
+        },
+        [this](Yngine::RemoveRowMove move) {
+            return this->next_action == NextAction::RowRemoval &&
+                this->is_row(index_to_pos(move.from), direction_to_vector(move.direction), this->white_to_move);
+        },
+        [this](Yngine::RemoveRingMove move) {
+            const auto pos = index_to_pos(move.index);
+            const auto ring = this->white_to_move ? Node::WhiteRing : Node::BlackRing;
+
+            return this->next_action == NextAction::RingRemoval &&
+                this->is_in_game(pos) && this->get_at(pos) == ring;
+        },
+        [this](Yngine::PassMove) {
+            return this->next_action == NextAction::RingMovement && !this->has_ring_moves();
+        },
+    }, move);
+}
+
+void ReferenceBoard::look_for_rows() {
+    if (!this->get_rows(this->white_to_move).empty()) {
+        this->next_action = NextAction::RowRemoval;
+    } else if (!this->get_rows(!this->white_to_move).empty()) {
+        this->next_action = NextAction::RowRemoval;
+        this->white_to_move = !this->white_to_move;
+    } else {
+        this->next_action = NextAction::RingMovement;
+        this->white_to_move = !this->white_moved_last;
+    }
+}
+
+void ReferenceBoard::apply_move(Yngine::Move move) {
+    assert(this->is_move_legal(move));
+
+    std::visit(variant_overloaded{
+        [this](Yngine::PlaceRingMove move) {
+            const auto pos = index_to_pos(move.index);
+            this->nodes[pos.x][pos.y] = this->white_to_move ? Node::WhiteRing : Node::BlackRing;
+
+            if (this->count(Node::WhiteRing) + this->count(Node::BlackRing) == 10) {
+                this->next_action = NextAction::RingMovement;
+            }
+
+            this->white_to_move = !this->white_to_move;
+        },
+        [this](Yngine::RingMove move) {
+            const auto from = index_to_pos(move.from);
+            const auto to = index_to_pos(move.to);
+
+            // The direction is found from the coordinates, the one of the move isn't trusted
+            HVec2 dir{};
+            for (const auto candidate : DIRECTIONS) {
+                for (auto pos = from + candidate; this->is_in_game(pos); pos += candidate) {
+                    if (pos == to) {
+                        dir = candidate;
+                    }
+                }
+            }
+
+            this->nodes[to.x][to.y] = this->nodes[from.x][from.y];
+            this->nodes[from.x][from.y] = this->white_to_move ? Node::WhiteMarker : Node::BlackMarker;
+
+            for (auto pos = from + dir; pos != to; pos += dir) {
+                auto& node = this->nodes[pos.x][pos.y];
+
+                if (node == Node::WhiteMarker) {
+                    node = Node::BlackMarker;
+                } else if (node == Node::BlackMarker) {
+                    node = Node::WhiteMarker;
+                }
+            }
+
+            this->white_moved_last = this->white_to_move;
+            this->look_for_rows();
+
+            // The 51st marker ends the game unless it made a row
+            if (this->next_action != NextAction::RowRemoval &&
+                this->count(Node::WhiteMarker) + this->count(Node::BlackMarker) == 51) {
+                this->next_action = NextAction::GameOver;
+            }
+        },
+        [this](Yngine::RemoveRowMove move) {
+            const auto from = index_to_pos(move.from);
+            const auto dir = direction_to_vector(move.direction);
+
+            for (int32_t i = 0; i < 5; i++) {
+                const auto pos = from + dir * i;
+                this->nodes[pos.x][pos.y] = Node::Empty;
+            }
+
+            this->next_action = NextAction::RingRemoval;
+        },
+        [this](Yngine::RemoveRingMove move) {
+            const auto pos = index_to_pos(move.index);
+            this->nodes[pos.x][pos.y] = Node::Empty;
+
+            auto& removed = this->white_to_move ? this->white_rings_removed : this->black_rings_removed;
+            removed++;
+
+            if (removed == 3) {
+                this->next_action = NextAction::GameOver;
+            } else {
+                this->look_for_rows();
+            }
+        },
+        [this](Yngine::PassMove) {
+            this->white_moved_last = this->white_to_move;
+            this->white_to_move = !this->white_to_move;
+        },
+    }, move);
+}
+
+std::vector<Yngine::Move> ReferenceBoard::get_legal_moves() const {
+    std::vector<Yngine::Move> result{};
+
+    switch (this->next_action) {
+    case NextAction::RingPlacement:
+    case NextAction::RingRemoval:
+        for (int32_t x = 0; x < 11; x++) {
+            for (int32_t y = 0; y < 11; y++) {
+                const auto index = pos_to_index(HVec2{x, y});
+
+                if (this->next_action == NextAction::RingPlacement) {
+                    result.push_back(Yngine::PlaceRingMove{index});
+                } else {
+                    result.push_back(Yngine::RemoveRingMove{index});
+                }
+            }
+        }
+        break;
+    case NextAction::RingMovement:
+        // Every node on the lines through the rings, the legality check decides
+        for (int32_t x = 0; x < 11; x++) {
+            for (int32_t y = 0; y < 11; y++) {
+                if (this->nodes[x][y] != (this->white_to_move ? Node::WhiteRing : Node::BlackRing))
+                    continue;
+
+                for (int direction = 0; direction < 6; direction++) {
+                    const auto from = HVec2{x, y};
+
+                    for (auto to = from + DIRECTIONS[direction]; this->is_in_game(to); to += DIRECTIONS[direction]) {
+                        result.push_back(Yngine::RingMove{
+                            pos_to_index(from),
+                            pos_to_index(to),
+                            static_cast<Yngine::Direction>(direction)
+                        });
+                    }
+                }
+            }
+        }
+        break;
+    case NextAction::RowRemoval:
+        for (const auto row : this->get_rows(this->white_to_move)) {
+            result.push_back(row);
+        }
+        break;
+    case NextAction::GameOver:
+        break;
+    }
+
+    std::erase_if(result, [this](Yngine::Move move) { return !this->is_move_legal(move); });
+
+    // Passing is legal exactly when no ring move is, which was just found out
+    // without asking has_ring_moves
+    if (this->next_action == NextAction::RingMovement && result.empty()) {
+        result.push_back(Yngine::PassMove{});
+    }
+
+    return result;
+}
+
+std::vector<Yngine::RemoveRowMove> ReferenceBoard::get_rows(bool white) const {
+    const auto marker = white ? Node::WhiteMarker : Node::BlackMarker;
+
+    std::vector<Yngine::RemoveRowMove> result{};
+
+    for (int32_t x = 0; x < 11; x++) {
+        for (int32_t y = 0; y < 11; y++) {
+            if (this->nodes[x][y] != marker)
+                continue;
+
+            for (const auto direction : ROW_DIRECTIONS) {
+                if (this->is_row(HVec2{x, y}, direction_to_vector(direction), white)) {
+                    result.push_back(Yngine::RemoveRowMove{pos_to_index(HVec2{x, y}), direction});
+                }
+            }
+        }
+    }
+
+    return result;
+}
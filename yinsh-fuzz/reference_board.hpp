@@ -0,0 +1,57 @@
+#ifndef YINSH_FUZZ_REFERENCE_BOARD_HPP
+#define YINSH_FUZZ_REFERENCE_BOARD_HPP
+
+#include <yinsh-core/board.hpp>
+
+#include <yngine/moves.hpp>
+
+#include <vector>
+
+// A second implementation of the rules that BoardState is checked against.
+// It is written to be obviously correct and not fast: nothing is updated
+// incrementally, the board shape comes from hex distances instead of the
+// offset tables and rows are found by scanning every node.
+// It follows the same conventions as BoardState where the rules leave a choice,
+// e.g. rows are listed only in the SE, NE and S directions
+class ReferenceBoard {
+public:
+    using NextAction = BoardState::NextAction;
+    using GameResult = BoardState::GameResult;
+
+    ReferenceBoard();
+
+    NextAction get_next_action() const;
+    bool is_whites_move() const;
+
+    // Should only be called when the game is over
+    GameResult get_game_result() const;
+
+    bool is_in_game(HVec2 pos) const;
+    Node get_at(HVec2 pos) const;
+
+    bool is_move_legal(Yngine::Move move) const;
+    void apply_move(Yngine::Move move);
+
+    std::vector<Yngine::Move> get_legal_moves() const;
+    std::vector<Yngine::RemoveRowMove> get_rows(bool white) const;
+
+private:
+    bool is_row(HVec2 from, HVec2 dir, bool white) const;
+    bool is_ring_move_legal(HVec2 from, HVec2 to) const;
+    bool has_ring_moves() const;
+    int count(Node piece) const;
+
+    // Decides who continues after a movement or a removed ring,
+    // the player to move removes their own rows first
+    void look_for_rows();
+
+    Node nodes[11][11];
+
+    NextAction next_action = NextAction::RingPlacement;
+    bool white_to_move = true;
+    bool white_moved_last = false;
+    int white_rings_removed = 0;
+    int black_rings_removed = 0;
+};
+
+#endif // YINSH_FUZZ_REFERENCE_BOARD_HPP
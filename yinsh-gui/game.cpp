@@ -1,8 +1,12 @@
 #include <yinsh-gui/game.hpp>
-#include <yinsh-gui/coords.hpp>
-#include <yinsh-gui/board.hpp>
-#include <yinsh-gui/utils.hpp>
-#include <yinsh-gui/system.hpp>
+#include <yinsh-core/notation.hpp>
+#include <yinsh-core/coords.hpp>
+#include <yinsh-core/board.hpp>
+#include <yinsh-core/profiler.hpp>
+#include <yinsh-core/utils.hpp>
+#include <yinsh-gui/raylib_utils.hpp>
+#include <yinsh-core/system.hpp>
+#include <yinsh-core/tuning.hpp>
 
 #include <raylib-cpp.hpp>
 #define RAYGUI_IMPLEMENTATION
@@ -14,6 +18,23 @@
 
 #include <cassert>
 #include <algorithm>
+#include <string>
+
+// The analysis engine is separate from the one that plays, so it is kept small
+static const AnalysisSettings ANALYSIS_SETTINGS{
+    .move_count = 3,
+    .search_time = 0.5f,
+    .thread_count = 4,
+    .memory_limit = 256 * 1024 * 1024,
+    .playouts_per_move = 32,
+    .variation_length = 4,
+};
+
+static const raylib::Color ANALYSIS_COLORS[3] = {
+    raylib::Color(0x1E88E5FF),
+    raylib::Color(0x43A047FF),
+    raylib::Color(0xFB8C00FF),
+};
 
 Game::Game()
     : window{}
@@ -22,13 +43,25 @@ Game::Game()
     , white_is_ai{false}
     , black_is_ai{false}
     , board_state{}
+    , timeline{}
+    , viewed_ply{}
+    , viewed_board_state{}
     , selected_ring{}
     , ring_moves{}
     , row_remove_from{}
     , row_remove_to{}
-    , engine{} {
+    , engine{}
+    , engine_construction{}
+    , analysis{}
+    , analysis_ply{0}
+    , analyzed_moves{}
+    , resident_memory{}
+    , memory_poll_timer{0}
+    , memory_before_engine{0}
+    , engine_memory_limit{0} {
     this->total_system_memory = get_system_memory();
     this->system_max_threads = get_system_threads();
+    this->default_thread_count = load_tuned_thread_count().value_or(this->system_max_threads);
 }
 
 void update_draw_frame(void* game_voidptr) {
@@ -75,27 +108,47 @@ void Game::run() {
 }
 
 void Game::update() {
+    YINSH_PROFILE_SCOPE("Game::update");
+
+#if defined(YINSH_PROFILING)
+    this->update_profiler();
+#endif
+
+    this->update_memory_usage();
+
     switch (this->state) {
     case State::ChoosingMode:
     case State::ChoosingAISettings: {
     } break;
     case State::Playing: {
+        this->update_history_view();
+        this->update_analysis();
+
+        if (!this->engine && this->engine_construction.valid()) {
+            this->poll_engine_construction();
+        }
+
         if (this->board_state.get_next_action() == BoardState::NextAction::GameOver)
             return;
 
         if ( this->board_state.is_whites_move() && this->white_is_ai ||
             !this->board_state.is_whites_move() && this->black_is_ai) {
-            assert(this->engine);
+            // The engine is still being constructed
+            if (!this->engine)
+                return;
 
             if (!this->engine_move) {
+                YINSH_PROFILE_ASYNC_BEGIN("engine search", 0);
                 this->engine_move = this->engine->search(this->ai_move_time, this->engine_thread_count);
             } else {
                 const auto move_status = this->engine_move->wait_for(std::chrono::seconds(0));
 
                 if (move_status == std::future_status::ready) {
+                    YINSH_PROFILE_ASYNC_END("engine search", 0);
                     const auto move = this->engine_move->get();
 
                     this->board_state.apply_move(move);
+                    this->timeline.push(move, this->board_state);
                     engine->apply_move(move);
 
                     this->engine_move = std::nullopt;
@@ -103,11 +156,16 @@ void Game::update() {
             }
 
         } else {
+            // The player can only move in the current position
+            if (this->viewed_ply)
+                return;
+
             const auto move = this->get_player_move();
 
             if (move) {
                 if (this->board_state.is_move_legal(*move)) {
                     this->board_state.apply_move(*move);
+                    this->timeline.push(*move, this->board_state);
 
                     if (this->engine) {
                         this->engine->apply_move(*move);
@@ -119,6 +177,203 @@ void Game::update() {
     }
 }
 
+void Game::start_engine_construction(std::size_t memory_limit, int thread_count) {
+    this->engine_memory_limit = memory_limit;
+
+    // The engines of an analysis that is still running aren't part of the baseline
+    const auto analysis_memory = this->analysis ? get_analysis_memory(ANALYSIS_SETTINGS) : 0;
+
+    // A previous engine is destroyed by the new task before it allocates,
+    // so that two engines never hold their memory at the same time
+    this->engine_construction = std::async(
+        std::launch::async,
+        [memory_limit, thread_count, analysis_memory, previous = std::move(this->engine_construction)]() mutable {
+            YINSH_PROFILE_SCOPE("engine construction");
+
+            if (previous.valid()) {
+                previous.get();
+            }
+
+            ConstructedEngine result{};
+            if (const auto resident = get_resident_memory()) {
+                result.memory_before = *resident > analysis_memory ? *resident - analysis_memory : 0;
+            }
+
+            result.engine = std::make_unique<Yngine::MCTS>(memory_limit);
+
+            // A short search from the initial position starts the search
+            // threads and touches the tree memory, the first real search
+            // then starts warm and reuses what was found here
+            constexpr float WARM_UP_SECONDS = 0.1f;
+            result.engine->search(WARM_UP_SECONDS, thread_count).wait();
+
+            return result;
+        }
+    );
+}
+
+void Game::poll_engine_construction() {
+    const auto status = this->engine_construction.wait_for(std::chrono::seconds(0));
+    if (status != std::future_status::ready)
+        return;
+
+    auto constructed = this->engine_construction.get();
+    this->engine = std::move(constructed.engine);
+    this->memory_before_engine = constructed.memory_before;
+
+    for (int ply = 1; ply <= this->timeline.get_ply_count(); ply++) {
+        this->engine->apply_move(this->timeline.get_move(ply));
+    }
+}
+
+void Game::update_analysis() {
+    const auto ply_count = this->timeline.get_ply_count();
+
+    // Results of an earlier position are of no use
+    if (this->analysis_ply != ply_count) {
+        this->analyzed_moves.clear();
+    }
+
+    if (this->analysis) {
+        const auto status = this->analysis->wait_for(std::chrono::seconds(0));
+        if (status != std::future_status::ready)
+            return;
+
+        auto analyzed_moves = this->analysis->get();
+        this->analysis = std::nullopt;
+
+        if (this->analysis_ply == ply_count) {
+            this->analyzed_moves = std::move(analyzed_moves);
+        }
+    }
+
+    if (raylib::Keyboard::IsKeyPressed(KEY_H) &&
+        this->board_state.get_next_action() != BoardState::NextAction::GameOver) {
+        std::vector<Yngine::Move> history{};
+        for (int ply = 1; ply <= ply_count; ply++) {
+            history.push_back(this->timeline.get_move(ply));
+        }
+
+        this->analysis_ply = ply_count;
+        this->analyzed_moves.clear();
+        this->analysis = std::async(std::launch::async, [history = std::move(history)] {
+            return analyze_position(history, ANALYSIS_SETTINGS);
+        });
+    }
+}
+
+void Game::draw_analysis_on_board() {
+    if (this->viewed_ply)
+        return;
+
+    // The worst move is drawn first so that the best one ends on top
+    for (int rank = static_cast<int>(this->analyzed_moves.size()) - 1; rank >= 0; rank--) {
+        const auto move = this->analyzed_moves[rank].move;
+        const auto color = ANALYSIS_COLORS[rank % 3];
+
+        std::visit(variant_overloaded{
+            [&](Yngine::PlaceRingMove move) {
+                const auto pos = to_hvector2(Yngine::Bitboard::index_to_coords(move.index));
+                DrawRing(to_vector2(pos.to_world()), 0.3f, 0.43f, 0.f, 360.f, 40, color.Fade(0.7));
+            },
+            [&](Yngine::RingMove move) {
+                const auto from = to_vector2(to_hvector2(Yngine::Bitboard::index_to_coords(move.from)).to_world());
+                const auto to = to_vector2(to_hvector2(Yngine::Bitboard::index_to_coords(move.to)).to_world());
+
+                from.DrawLine(to, 0.1f, color.Fade(0.7));
+                to.DrawCircle(0.2f, color.Fade(0.7));
+            },
+            [&](Yngine::RemoveRowMove move) {
+                const auto from = to_hvector2(Yngine::Bitboard::index_to_coords(move.from));
+                const auto to = from + HVec2::from_direction(move.direction) * 4;
+
+                to_vector2(from.to_world()).DrawLine(to_vector2(to.to_world()), 0.5f, color.Fade(0.4));
+            },
+            [&](Yngine::RemoveRingMove move) {
+                const auto pos = to_hvector2(Yngine::Bitboard::index_to_coords(move.index));
+                to_vector2(pos.to_world()).DrawCircle(0.5f, color.Fade(0.4));
+            },
+            [&](Yngine::PassMove move) {
+            },
+        }, move);
+    }
+}
+
+void Game::draw_analysis_list() {
+    const auto window_size = window.GetSize();
+
+    if (this->analysis) {
+        GuiLabel(Rectangle{window_size.x - 510, 80, 500, 30}, "Analyzing...");
+        return;
+    }
+
+    if (this->viewed_ply)
+        return;
+
+    for (std::size_t rank = 0; rank < this->analyzed_moves.size(); rank++) {
+        const auto& root_move = this->analyzed_moves[rank];
+
+        std::string replies{};
+        for (std::size_t i = 1; i < root_move.principal_variation.size(); i++) {
+            replies += i == 1 ? "" : ", ";
+            replies += move_to_string(root_move.principal_variation[i]);
+        }
+
+        // The score of random playouts isn't what the AI thinks of the move
+        GuiLabel(
+            Rectangle{window_size.x - 510, 80 + 60.f * rank, 500, 30},
+            TextFormat(
+                "%zu. %s%s, random playouts %.0f%%",
+                rank + 1,
+                move_to_string(root_move.move).c_str(),
+                root_move.is_engine_move ? ", AI's choice" : "",
+                100.f * root_move.playout_score
+            )
+        );
+
+        // Only the engine's move has replies
+        if (!replies.empty()) {
+            GuiLabel(
+                Rectangle{window_size.x - 480, 105 + 60.f * rank, 470, 30},
+                TextFormat("then %s", replies.c_str())
+            );
+        }
+    }
+}
+
+void Game::update_history_view() {
+    const auto ply_count = this->timeline.get_ply_count();
+    auto ply = this->viewed_ply.value_or(ply_count);
+
+    const auto wheel_move = raylib::Mouse::GetWheelMove();
+
+    if (raylib::Keyboard::IsKeyPressed(KEY_LEFT) || wheel_move > 0) {
+        ply--;
+    } else if (raylib::Keyboard::IsKeyPressed(KEY_RIGHT) || wheel_move < 0) {
+        ply++;
+    } else if (raylib::Keyboard::IsKeyPressed(KEY_HOME)) {
+        ply = 0;
+    } else if (raylib::Keyboard::IsKeyPressed(KEY_END)) {
+        ply = ply_count;
+    }
+
+    ply = std::clamp(ply, 0, ply_count);
+
+    if (ply == ply_count) {
+        this->viewed_ply = std::nullopt;
+        return;
+    }
+
+    if (ply != this->viewed_ply) {
+        this->viewed_ply = ply;
+        this->viewed_board_state = this->timeline.get_position(ply);
+
+        // Selections only make sense in the current position
+        this->selected_ring = std::nullopt;
+        this->row_remove_from = std::nullopt;
+    }
+}
+
 std::optional<Yngine::Move> Game::get_player_move() {
     switch (this->board_state.get_next_action()) {
     case BoardState::NextAction::RingPlacement: {
@@ -212,6 +467,28 @@ std::optional<Yngine::Move> Game::get_player_move() {
                             HVec3{from}.direction_to(row_remove_to)
                         };
                     }
+
+                    // A click on a marker that only belongs to one row removes that row
+                    if (diff.length() == 0) {
+                        std::optional<Yngine::RemoveRowMove> clicked_row{};
+                        int clicked_row_count = 0;
+
+                        for (const auto row : this->board_state.get_rows(this->board_state.is_whites_move())) {
+                            const auto row_from = to_hvector2(Yngine::Bitboard::index_to_coords(row.from));
+                            const auto dir = HVec2::from_direction(row.direction);
+
+                            for (int32_t i = 0; i < 5; i++) {
+                                if (row_from + dir * i == from) {
+                                    clicked_row = row;
+                                    clicked_row_count++;
+                                }
+                            }
+                        }
+
+                        if (clicked_row_count == 1) {
+                            return *clicked_row;
+                        }
+                    }
                 }
             } else {
                 if (raylib::Mouse::IsButtonReleased(MOUSE_BUTTON_LEFT)) {
@@ -240,6 +517,8 @@ std::optional<Yngine::Move> Game::get_player_move() {
 }
 
 void Game::render() {
+    YINSH_PROFILE_SCOPE("Game::render");
+
     if (this->window.IsResized()) {
         this->update_camera();
     }
@@ -288,11 +567,7 @@ void Game::render() {
 
         const int total_system_memory_mb = this->total_system_memory / 1024 / 1024;
         if (memory_limit_mb == 0) {
-            if (this->total_system_memory >= 2 * 1024) {
-                memory_limit_mb = 2048;
-            } else {
-                memory_limit_mb = memory_limit_mb;
-            }
+            memory_limit_mb = std::min(2048, total_system_memory_mb);
         }
 
         float memory_limit_mb_float = memory_limit_mb;
@@ -305,7 +580,7 @@ void Game::render() {
         );
         memory_limit_mb = static_cast<std::size_t>(memory_limit_mb_float);
 
-        static std::size_t thread_count = this->system_max_threads;
+        static std::size_t thread_count = this->default_thread_count;
         float thread_count_float = thread_count;
         GuiSlider(
             Rectangle{window_size.x / 2, window_size.y / 2 + 60, 100, 30},
@@ -317,6 +592,10 @@ void Game::render() {
         thread_count = static_cast<std::size_t>(thread_count_float);
         this->engine_thread_count = thread_count;
 
+        if (!this->engine_construction.valid()) {
+            this->start_engine_construction(memory_limit_mb * 1024 * 1024, thread_count);
+        }
+
         if (GuiButton(
             Rectangle{window_size.x / 2 - 100, window_size.y / 2 + 100, 200, 30},
             "Play"
@@ -331,7 +610,10 @@ void Game::render() {
 
             this->ai_move_time = move_time;
 
-            this->engine.emplace(memory_limit_mb * 1024 * 1024);
+            // The engine that is being built has a different memory limit
+            if (this->engine_memory_limit != memory_limit_mb * 1024 * 1024) {
+                this->start_engine_construction(memory_limit_mb * 1024 * 1024, thread_count);
+            }
 
             this->state = Game::State::Playing;
         }
@@ -339,14 +621,39 @@ void Game::render() {
     case State::Playing: {
         this->camera.BeginMode();
         this->draw_board();
+        this->draw_analysis_on_board();
         this->camera.EndMode();
+
+        this->draw_memory_usage();
+        this->draw_analysis_list();
+
+        if (this->viewed_ply) {
+            GuiLabel(
+                Rectangle{10, 10, 500, 30},
+                TextFormat(
+                    "Move %i of %i, press End to return",
+                    *this->viewed_ply,
+                    this->timeline.get_ply_count()
+                )
+            );
+        }
     } break;
     }
 
+#if defined(YINSH_PROFILING)
+    if (this->show_profiler_hud) {
+        this->draw_profiler_hud();
+    }
+#endif
+
     EndDrawing();
 }
 
 void Game::draw_board() {
+    YINSH_PROFILE_SCOPE("Game::draw_board");
+
+    const auto& board_state = this->viewed_ply ? this->viewed_board_state : this->board_state;
+
     const float line_thickness = 0.04f;
     const auto line_color = raylib::Color(0x383838FF);
 
@@ -382,6 +689,25 @@ void Game::draw_board() {
         }
     }
 
+    // Show the rows the player can remove
+    const bool player_removes_row =
+        !this->viewed_ply &&
+        board_state.get_next_action() == BoardState::NextAction::RowRemoval &&
+        !(board_state.is_whites_move() ? this->white_is_ai : this->black_is_ai);
+
+    if (player_removes_row) {
+        for (const auto row : board_state.get_rows(board_state.is_whites_move())) {
+            const auto from = to_hvector2(Yngine::Bitboard::index_to_coords(row.from));
+            const auto to = from + HVec2::from_direction(row.direction) * 4;
+
+            to_vector2(from.to_world()).DrawLine(
+                to_vector2(to.to_world()),
+                0.7f,
+                raylib::Color::Red().Fade(0.25)
+            );
+        }
+    }
+
     // Draw selected row for removal if needed
     if (this->row_remove_from) {
         if (*this->row_remove_from != this->row_remove_to) {
@@ -404,9 +730,9 @@ void Game::draw_board() {
         for (int32_t y = 0; y < 11; y++) {
             const auto pos = HVec2{x, y};
 
-            if (this->board_state.is_in_game(pos)) {
+            if (board_state.is_in_game(pos)) {
                 const auto pos_world = to_vector2(pos.to_world());
-                const auto piece = this->board_state.get_at(pos);
+                const auto piece = board_state.get_at(pos);
 
                 switch (piece) {
                 case Node::WhiteRing: [[fallthrough]];
@@ -454,6 +780,50 @@ void Game::update_camera() {
     }
 }
 
+void Game::update_memory_usage() {
+    this->memory_poll_timer -= GetFrameTime();
+
+    if (this->memory_poll_timer <= 0) {
+        this->resident_memory = get_resident_memory();
+        this->memory_poll_timer = 1;
+    }
+}
+
+void Game::draw_memory_usage() {
+    if (!this->resident_memory)
+        return;
+
+    const auto window_size = window.GetSize();
+
+    GuiLabel(
+        Rectangle{10, window_size.y - 40, 500, 30},
+        TextFormat("Memory: %zu MB resident", *this->resident_memory / 1024 / 1024)
+    );
+
+    if (this->engine) {
+        const auto analysis_memory = this->analysis ? get_analysis_memory(ANALYSIS_SETTINGS) : 0;
+        const auto baseline = this->memory_before_engine + analysis_memory;
+
+        const auto engine_memory =
+            *this->resident_memory > baseline ? *this->resident_memory - baseline : 0;
+
+        GuiLabel(
+            Rectangle{10, window_size.y - 70, 500, 30},
+            TextFormat(
+                "AI: ~%zu MB of %zu MB (%.0f%%)",
+                engine_memory / 1024 / 1024,
+                this->engine_memory_limit / 1024 / 1024,
+                100.0 * engine_memory / this->engine_memory_limit
+            )
+        );
+    } else if (this->engine_construction.valid()) {
+        GuiLabel(
+            Rectangle{10, window_size.y - 70, 500, 30},
+            TextFormat("AI: starting, %zu MB", this->engine_memory_limit / 1024 / 1024)
+        );
+    }
+}
+
 HVec2 Game::get_mouse_hex_pos() {
     const auto mouse_pos = raylib::Mouse::GetPosition();
     const auto world_pos = this->camera.GetScreenToWorld(mouse_pos);
@@ -461,3 +831,51 @@ HVec2 Game::get_mouse_hex_pos() {
 
     return hex_pos;
 }
+
+#if defined(YINSH_PROFILING)
+void Game::update_profiler() {
+    this->frame_times[this->frame_count % this->frame_times.size()] = GetFrameTime();
+    this->frame_count++;
+
+    if (raylib::Keyboard::IsKeyPressed(KEY_F2)) {
+        Profiler::write_chrome_trace("yinsh-trace.json");
+    }
+
+    if (raylib::Keyboard::IsKeyPressed(KEY_F3)) {
+        this->show_profiler_hud = !this->show_profiler_hud;
+    }
+}
+
+void Game::draw_profiler_hud() {
+    const auto recorded_frames = std::min(this->frame_count, this->frame_times.size());
+    if (recorded_frames == 0)
+        return;
+
+    auto sorted_times = this->frame_times;
+    std::sort(sorted_times.begin(), sorted_times.begin() + recorded_frames);
+
+    const auto percentile = [&](float fraction) {
+        const auto index = static_cast<std::size_t>(fraction * (recorded_frames - 1));
+        return sorted_times[index] * 1000.f;
+    };
+
+    const auto window_size = window.GetSize();
+
+    GuiLabel(
+        Rectangle{window_size.x - 310, 10, 300, 30},
+        TextFormat(
+            "frame p50 %.1fms p95 %.1fms",
+            percentile(0.5f),
+            percentile(0.95f)
+        )
+    );
+    GuiLabel(
+        Rectangle{window_size.x - 310, 40, 300, 30},
+        TextFormat(
+            "frame p99 %.1fms max %.1fms",
+            percentile(0.99f),
+            percentile(1.f)
+        )
+    );
+}
+#endif
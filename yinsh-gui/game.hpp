@@ -1,11 +1,18 @@
 #ifndef YINSH_GUI_GAME_HPP
 #define YINSH_GUI_GAME_HPP
 
-#include <yinsh-gui/board.hpp>
+#include <yinsh-core/analysis.hpp>
+#include <yinsh-core/board.hpp>
+#include <yinsh-core/timeline.hpp>
+#include <yinsh-core/system.hpp>
 
 #include <yngine/mcts.hpp>
 
 #include <raylib-cpp.hpp>
+
+#include <array>
+#include <future>
+#include <memory>
 #include <optional>
 
 class Game {
@@ -30,6 +37,9 @@ private:
     void update();
     std::optional<Yngine::Move> get_player_move();
 
+    // Scrubs through the played moves with the arrow keys and the mouse wheel
+    void update_history_view();
+
     void render();
     void draw_board();
 
@@ -38,6 +48,16 @@ private:
 
     HVec2 get_mouse_hex_pos();
 
+#if defined(YINSH_PROFILING)
+    // F2 writes a Chrome trace, F3 toggles the frame time overlay
+    void update_profiler();
+    void draw_profiler_hud();
+
+    bool show_profiler_hud = false;
+    std::array<float, 240> frame_times{};
+    std::size_t frame_count = 0;
+#endif
+
     raylib::Window window;
     raylib::Camera2D camera;
 
@@ -48,6 +68,11 @@ private:
 
     BoardState board_state;
 
+    GameTimeline timeline;
+    // Not null while the player looks at an earlier position
+    std::optional<int> viewed_ply;
+    BoardState viewed_board_state;
+
     std::optional<HVec2> selected_ring; // Ring that the player wants to move
     std::vector<HVec2> ring_moves;
 
@@ -56,13 +81,50 @@ private:
     // Used to draw the line player selected
     HVec2 row_remove_to;
 
-    // Not null if we play against AI
-    std::optional<Yngine::MCTS> engine;
+    // Creating the engine commits its memory, so it is built and warmed up
+    // in the background while the player chooses the AI settings
+    void start_engine_construction(std::size_t memory_limit, int thread_count);
+    // Takes the engine once it is ready and replays the moves played meanwhile
+    void poll_engine_construction();
+
+    struct ConstructedEngine {
+        std::unique_ptr<Yngine::MCTS> engine;
+        // Resident memory of the process before the engine was created
+        std::size_t memory_before;
+    };
+
+    // Not null if we play against AI and the engine is ready
+    std::unique_ptr<Yngine::MCTS> engine;
+    std::future<ConstructedEngine> engine_construction;
     std::optional<std::future<Yngine::Move>> engine_move;
     int engine_thread_count;
 
+    // H analyzes the current position in the background,
+    // the best moves are drawn ranked on the board
+    void update_analysis();
+    void draw_analysis_on_board();
+    void draw_analysis_list();
+
+    std::optional<std::future<std::vector<RootMove>>> analysis;
+    // Ply of the position that is or was analyzed
+    int analysis_ply;
+    std::vector<RootMove> analyzed_moves;
+
+    // Resident memory is polled once a second, the tree memory used by the
+    // engine is estimated as the growth of the process since it was created
+    // without the engines of a running analysis
+    void update_memory_usage();
+    void draw_memory_usage();
+
+    std::optional<std::size_t> resident_memory;
+    float memory_poll_timer;
+    std::size_t memory_before_engine;
+    std::size_t engine_memory_limit;
+
     std::size_t total_system_memory;
     int system_max_threads;
+    // Tuned by Yinsh-bench if it was run on this machine
+    int default_thread_count;
 };
 
 #endif // YINSH_GUI_GAME_HPP
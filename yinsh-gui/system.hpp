@@ -1,9 +0,0 @@
-#ifndef YINSH_GUI_SYSTEM_HPP
-#define YINSH_GUI_SYSTEM_HPP
-
-#include <cstddef>
-
-std::size_t get_system_memory();
-int get_system_threads();
-
-#endif // YINSH_GUI_SYSTEM_HPP
@@ -0,0 +1,351 @@
+#include <yinsh-selfplay/work_queue.hpp>
+#include <yinsh-core/match.hpp>
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+
+static void print_usage(const char* program) {
+    std::fprintf(
+        stderr,
+        "Usage: %s coordinate --queue DIR [--games N] [--seed N] [--threads N] [--opponent-threads N]\n"
+        "                 [--move-time S] [--memory MB] [--lease S] [--attempts N]\n"
+        "       %s work --queue DIR [--name NAME]\n"
+        "\n"
+        "coordinate creates the queue, or resumes it if it exists, puts back the jobs of\n"
+        "workers that stopped and collects the finished games into DIR/games.txt\n"
+        "  --queue             directory shared by the coordinator and all workers\n"
+        "  --games             games to play, pairs of games share an opening (default 100)\n"
+        "  --seed              seed of the openings (default 1)\n"
+        "  --threads           threads of the first engine (default 1)\n"
+        "  --opponent-threads  threads of the second engine (default the same as --threads)\n"
+        "  --move-time         search time per move (default 0.5)\n"
+        "  --memory            search tree memory of each engine (default 256)\n"
+        "  --lease             seconds after which the job of a silent worker is put back, the clocks\n"
+        "                      of all the machines that share the queue must agree, at least 30 (default 120)\n"
+        "  --attempts          a job is moved to failed/ when its lease runs out for the Nth time (default 3)\n"
+        "\n"
+        "work plays jobs until every game of the queue is finished\n"
+        "  --name              name of the worker in the game records (default random)\n",
+        program,
+        program
+    );
+}
+
+static bool parse_positive(std::string_view text, int& result) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result);
+    return error == std::errc{} && end == text.data() + text.size() && result > 0;
+}
+
+static bool parse_positive(const char* text, float& result) {
+    char* end;
+    result = std::strtof(text, &end);
+    return end != text && *end == '\0' && result > 0;
+}
+
+static constexpr auto POLL_INTERVAL = std::chrono::seconds(1);
+// Must be well below the lease, also on machines whose clocks differ a bit
+static constexpr auto RENEW_INTERVAL = std::chrono::seconds(10);
+// A few renewals may be late or missed before a job of a working worker is put back
+static constexpr auto MIN_LEASE = 3 * RENEW_INTERVAL;
+
+static int coordinate(
+    WorkQueue& queue,
+    const std::filesystem::path& queue_directory,
+    int game_count,
+    int seed,
+    const EngineSettings& first,
+    const EngineSettings& second,
+    std::chrono::seconds lease,
+    int max_attempts
+) {
+    if (const auto existing_game_count = queue.get_game_count()) {
+        game_count = *existing_game_count;
+        std::printf("Resuming the queue with %i games\n", game_count);
+    } else {
+        std::vector<SelfPlayJob> jobs{};
+
+        // Both engines play every opening with each color
+        const auto openings = generate_reference_positions((game_count + 1) / 2, seed);
+
+        for (int i = 0; i < game_count; i++) {
+            const bool first_is_white = i % 2 == 0;
+
+            jobs.push_back(SelfPlayJob{
+                .id = i,
+                .attempt = 0,
+                .claim_token = {},
+                .white = first_is_white ? first : second,
+                .black = first_is_white ? second : first,
+                .opening = openings[i / 2],
+            });
+        }
+
+        if (!queue.create(jobs)) {
+            std::fprintf(stderr, "Could not create the queue in %s\n", queue_directory.string().c_str());
+            return 1;
+        }
+
+        std::printf("Created a queue with %i games\n", game_count);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto done_at_start = queue.count().done;
+
+    while (true) {
+        const auto requeued_count = queue.requeue_expired(lease, max_attempts);
+        if (requeued_count > 0) {
+            std::printf("\n%i jobs of workers that stopped were put back or given up\n", requeued_count);
+        }
+
+        const auto counts = queue.count();
+
+        const auto hours = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() / 3600.f;
+        const auto games_per_hour = hours > 0 ? (counts.done - done_at_start) / hours : 0.f;
+
+        std::printf(
+            "\rdone %i/%i, playing %i, pending %i, failed %i, %.0f games/hour   ",
+            counts.done, game_count, counts.claimed, counts.pending, counts.failed, games_per_hour
+        );
+        std::fflush(stdout);
+
+        if (counts.done + counts.failed >= game_count && counts.pending == 0 && counts.claimed == 0)
+            break;
+
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+
+    std::printf("\n");
+
+    const auto games = queue.read_finished_games();
+
+    std::ofstream games_file{queue_directory / "games.txt"};
+    for (const auto& game : games) {
+        games_file << finished_game_to_string(game) << '\n';
+    }
+
+    if (!games_file) {
+        std::fprintf(stderr, "Could not write the games\n");
+        return 1;
+    }
+
+    // The first engine plays white in the even jobs
+    float first_points = 0;
+
+    struct WorkerStats {
+        int games;
+        float seconds;
+        std::size_t plies;
+    };
+    std::map<std::string, WorkerStats> workers{};
+
+    for (const auto& game : games) {
+        using GameResult = BoardState::GameResult;
+
+        const bool first_is_white = game.job_id % 2 == 0;
+        if (game.record.result == GameResult::Draw) {
+            first_points += 0.5f;
+        } else if ((game.record.result == GameResult::WhiteWon) == first_is_white) {
+            first_points += 1.f;
+        }
+
+        auto& worker = workers[game.worker];
+        worker.games++;
+        worker.seconds += game.seconds;
+        worker.plies += game.record.moves.size();
+    }
+
+    std::printf(
+        "%zu games, %i failed, %i threads scored %.1f/%zu against %i threads\n",
+        games.size(),
+        queue.count().failed,
+        first.thread_count,
+        first_points,
+        games.size(),
+        second.thread_count
+    );
+
+    std::printf("\nworker                  games   plies/s\n");
+    for (const auto& [name, worker] : workers) {
+        std::printf(
+            "%-22s %6i   %7.1f\n",
+            name.c_str(),
+            worker.games,
+            worker.seconds > 0 ? worker.plies / worker.seconds : 0.f
+        );
+    }
+
+    std::printf("\nThe games are in %s\n", (queue_directory / "games.txt").string().c_str());
+
+    return 0;
+}
+
+static int work(WorkQueue& queue, const std::string& name) {
+    std::optional<int> game_count;
+    while (!(game_count = queue.get_game_count())) {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+
+    std::printf("Worker %s joined a queue with %i games\n", name.c_str(), *game_count);
+
+    while (true) {
+        const auto job = queue.claim();
+
+        if (!job) {
+            const auto counts = queue.count();
+            if (counts.done + counts.failed >= *game_count)
+                break;
+
+            // The jobs of stopped workers are put back after their lease
+            std::this_thread::sleep_for(POLL_INTERVAL);
+            continue;
+        }
+
+        std::atomic<bool> is_playing = true;
+        std::thread renewer{[&queue, &job, &is_playing] {
+            auto last_renewed = std::chrono::steady_clock::now();
+
+            while (is_playing) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+                if (std::chrono::steady_clock::now() - last_renewed >= RENEW_INTERVAL) {
+                    queue.renew(*job);
+                    last_renewed = std::chrono::steady_clock::now();
+                }
+            }
+        }};
+
+        const auto start = std::chrono::steady_clock::now();
+        auto record = play_game(job->opening, job->white, job->black);
+        const auto seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+        is_playing = false;
+        renewer.join();
+
+        const auto finished = queue.finish(*job, FinishedGame{
+            .job_id = job->id,
+            .worker = name,
+            .seconds = seconds,
+            .white = job->white,
+            .black = job->black,
+            .record = std::move(record),
+        });
+
+        if (!finished) {
+            std::fprintf(stderr, "Could not store the game of job %i, it will be played again\n", job->id);
+            continue;
+        }
+
+        std::printf("Finished job %i in %.1fs\n", job->id, seconds);
+    }
+
+    std::printf("Every game is finished\n");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string_view mode = argv[1];
+    if (mode != "coordinate" && mode != "work") {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::string queue_directory{};
+    std::string name{};
+    int game_count = 100;
+    int seed = 1;
+    int thread_count = 1;
+    int opponent_thread_count = 0;
+    float move_time = 0.5f;
+    int memory_limit_mb = 256;
+    int lease_seconds = 120;
+    int max_attempts = 3;
+
+    for (int i = 2; i < argc; i++) {
+        const std::string_view option = argv[i];
+
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        const char* value = argv[++i];
+
+        bool is_valid = true;
+        if (option == "--queue") {
+            queue_directory = value;
+        } else if (option == "--name") {
+            name = value;
+            is_valid = !name.empty() && name.find_first_of(" \t\n") == std::string::npos;
+        } else if (option == "--games") {
+            is_valid = parse_positive(value, game_count);
+        } else if (option == "--seed") {
+            is_valid = parse_positive(value, seed);
+        } else if (option == "--threads") {
+            is_valid = parse_positive(value, thread_count);
+        } else if (option == "--opponent-threads") {
+            is_valid = parse_positive(value, opponent_thread_count);
+        } else if (option == "--move-time") {
+            is_valid = parse_positive(value, move_time);
+        } else if (option == "--memory") {
+            is_valid = parse_positive(value, memory_limit_mb);
+        } else if (option == "--lease") {
+            is_valid = parse_positive(value, lease_seconds) && std::chrono::seconds(lease_seconds) >= MIN_LEASE;
+        } else if (option == "--attempts") {
+            is_valid = parse_positive(value, max_attempts);
+        } else {
+            is_valid = false;
+        }
+
+        if (!is_valid) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (queue_directory.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    WorkQueue queue{queue_directory};
+
+    if (mode == "work") {
+        if (name.empty()) {
+            std::random_device random_device{};
+            name = "worker-" + std::to_string(random_device() % 100000);
+        }
+
+        return work(queue, name);
+    }
+
+    if (opponent_thread_count == 0) {
+        opponent_thread_count = thread_count;
+    }
+
+    const auto memory_limit = static_cast<std::size_t>(memory_limit_mb) * 1024 * 1024;
+
+    return coordinate(
+        queue,
+        queue_directory,
+        game_count,
+        seed,
+        EngineSettings{thread_count, move_time, memory_limit},
+        EngineSettings{opponent_thread_count, move_time, memory_limit},
+        std::chrono::seconds(lease_seconds),
+        max_attempts
+    );
+}
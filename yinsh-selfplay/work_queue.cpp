@@ -0,0 +1,420 @@
+#include <yinsh-selfplay/work_queue.hpp>
+#include <yinsh-core/notation.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+static constexpr std::size_t MB = 1024 * 1024;
+
+static void write_settings(std::ostream& stream, const char* key, const EngineSettings& settings) {
+    stream
+        << key << ' ' << settings.thread_count
+        << ' ' << settings.move_time
+        << ' ' << settings.memory_limit / MB << '\n';
+}
+
+static bool read_settings(std::istream& stream, EngineSettings& settings) {
+    std::size_t memory_limit_mb;
+    if (!(stream >> settings.thread_count >> settings.move_time >> memory_limit_mb))
+        return false;
+
+    settings.memory_limit = memory_limit_mb * MB;
+    return settings.thread_count > 0 && settings.move_time > 0 && settings.memory_limit > 0;
+}
+
+static const char* game_result_to_string(BoardState::GameResult result) {
+    switch (result) {
+    case BoardState::GameResult::WhiteWon:
+        return "white";
+    case BoardState::GameResult::BlackWon:
+        return "black";
+    case BoardState::GameResult::Draw:
+        return "draw";
+    default:
+        abort();
+    }
+}
+
+// Files are written under a hidden name and renamed into place, so readers
+// never see a partially written file
+static bool write_file_atomically(const std::filesystem::path& path, const std::string& content) {
+    std::random_device random_device{};
+    const auto temporary_path =
+        path.parent_path() / (".tmp-" + path.filename().string() + '-' + std::to_string(random_device()));
+
+    {
+        std::ofstream file{temporary_path};
+        file << content;
+        file.close();
+
+        if (!file) {
+            std::error_code error;
+            std::filesystem::remove(temporary_path, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+
+    return true;
+}
+
+static std::string job_to_string(const SelfPlayJob& job) {
+    std::ostringstream result;
+
+    result << "job " << job.id << '\n';
+    result << "attempt " << job.attempt << '\n';
+    if (!job.claim_token.empty()) {
+        result << "claim " << job.claim_token << '\n';
+    }
+    write_settings(result, "white", job.white);
+    write_settings(result, "black", job.black);
+
+    for (const auto move : job.opening) {
+        result << "move " << move_to_string(move) << '\n';
+    }
+
+    return result.str();
+}
+
+static std::optional<SelfPlayJob> read_job(const std::filesystem::path& path) {
+    std::ifstream file{path};
+
+    SelfPlayJob job{};
+    bool has_id = false, has_white = false, has_black = false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream{line};
+
+        std::string key;
+        if (!(stream >> key))
+            continue;
+
+        bool is_valid = true;
+        if (key == "job") {
+            is_valid = has_id = static_cast<bool>(stream >> job.id);
+        } else if (key == "attempt") {
+            is_valid = static_cast<bool>(stream >> job.attempt);
+        } else if (key == "claim") {
+            is_valid = static_cast<bool>(stream >> job.claim_token);
+        } else if (key == "white") {
+            is_valid = has_white = read_settings(stream, job.white);
+        } else if (key == "black") {
+            is_valid = has_black = read_settings(stream, job.black);
+        } else if (key == "move") {
+            const auto move = parse_move(stream);
+            if (move) {
+                job.opening.push_back(*move);
+            }
+            is_valid = move.has_value();
+        }
+
+        if (!is_valid)
+            return std::nullopt;
+    }
+
+    if (!has_id || !has_white || !has_black)
+        return std::nullopt;
+
+    return job;
+}
+
+static std::optional<FinishedGame> read_finished_game(const std::filesystem::path& path) {
+    std::ifstream file{path};
+
+    FinishedGame game{};
+    bool has_id = false, has_result = false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream{line};
+
+        std::string key;
+        if (!(stream >> key))
+            continue;
+
+        bool is_valid = true;
+        if (key == "job") {
+            is_valid = has_id = static_cast<bool>(stream >> game.job_id);
+        } else if (key == "worker") {
+            is_valid = static_cast<bool>(stream >> game.worker);
+        } else if (key == "seconds") {
+            is_valid = static_cast<bool>(stream >> game.seconds);
+        } else if (key == "white") {
+            is_valid = read_settings(stream, game.white);
+        } else if (key == "black") {
+            is_valid = read_settings(stream, game.black);
+        } else if (key == "result") {
+            std::string result;
+            stream >> result;
+
+            has_result = true;
+            if (result == "white") {
+                game.record.result = BoardState::GameResult::WhiteWon;
+            } else if (result == "black") {
+                game.record.result = BoardState::GameResult::BlackWon;
+            } else if (result == "draw") {
+                game.record.result = BoardState::GameResult::Draw;
+            } else {
+                is_valid = false;
+            }
+        } else if (key == "move") {
+            const auto move = parse_move(stream);
+            if (move) {
+                game.record.moves.push_back(*move);
+            }
+            is_valid = move.has_value();
+        }
+
+        if (!is_valid)
+            return std::nullopt;
+    }
+
+    if (!has_id || !has_result)
+        return std::nullopt;
+
+    return game;
+}
+
+std::string finished_game_to_string(const FinishedGame& game) {
+    std::ostringstream content;
+
+    content << "job " << game.job_id << '\n';
+    content << "worker " << game.worker << '\n';
+    content << "seconds " << game.seconds << '\n';
+    write_settings(content, "white", game.white);
+    write_settings(content, "black", game.black);
+    content << "result " << game_result_to_string(game.record.result) << '\n';
+
+    for (const auto move : game.record.moves) {
+        content << "move " << move_to_string(move) << '\n';
+    }
+
+    return content.str();
+}
+
+WorkQueue::WorkQueue(std::filesystem::path directory)
+    : directory{std::move(directory)} {
+}
+
+bool WorkQueue::create(const std::vector<SelfPlayJob>& jobs) {
+    std::error_code error;
+
+    if (std::filesystem::exists(this->directory / "queue.txt", error))
+        return false;
+
+    for (const auto state : {"pending", "claimed", "done", "failed"}) {
+        std::filesystem::create_directories(this->directory / state, error);
+        if (error)
+            return false;
+    }
+
+    // Jobs left by a crash during an earlier creation are overwritten,
+    // no worker could have claimed them before queue.txt existed
+    for (const auto& job : jobs) {
+        if (!this->enqueue(job))
+            return false;
+    }
+
+    return write_file_atomically(
+        this->directory / "queue.txt",
+        "games " + std::to_string(jobs.size()) + '\n'
+    );
+}
+
+std::optional<int> WorkQueue::get_game_count() const {
+    std::ifstream file{this->directory / "queue.txt"};
+
+    std::string key;
+    int game_count;
+    if (!(file >> key >> game_count) || key != "games")
+        return std::nullopt;
+
+    return game_count;
+}
+
+bool WorkQueue::enqueue(const SelfPlayJob& job) {
+    return write_file_atomically(this->get_path("pending", job.id), job_to_string(job));
+}
+
+std::optional<SelfPlayJob> WorkQueue::claim() {
+    std::error_code error;
+
+    for (const auto& entry : std::filesystem::directory_iterator{this->directory / "pending", error}) {
+        const auto filename = entry.path().filename().string();
+        if (filename.starts_with("."))
+            continue;
+
+        const auto claimed_path = this->directory / "claimed" / filename;
+
+        // The lease starts now and not when the job was created. Only one of
+        // the workers that race for the job succeeds with the rename
+        std::filesystem::last_write_time(entry.path(), std::filesystem::file_time_type::clock::now(), error);
+        if (error)
+            continue;
+
+        std::filesystem::rename(entry.path(), claimed_path, error);
+        if (error)
+            continue;
+
+        auto job = read_job(claimed_path);
+        if (!job) {
+            // Nobody can play a broken job, so it doesn't wait for the lease
+            std::filesystem::rename(claimed_path, this->directory / "failed" / filename, error);
+            continue;
+        }
+
+        // The lease was just renewed, so the job can't be put back before the
+        // token is written. If writing fails the job runs out its lease
+        std::random_device random_device{};
+        job->claim_token = std::to_string(random_device()) + '-' + std::to_string(random_device());
+
+        if (!write_file_atomically(claimed_path, job_to_string(*job)))
+            continue;
+
+        return job;
+    }
+
+    return std::nullopt;
+}
+
+void WorkQueue::renew(const SelfPlayJob& job) {
+    const auto claimed_path = this->get_path("claimed", job.id);
+    if (!this->is_claimed_by(claimed_path, job))
+        return;
+
+    std::error_code error;
+    std::filesystem::last_write_time(claimed_path, std::filesystem::file_time_type::clock::now(), error);
+}
+
+bool WorkQueue::finish(const SelfPlayJob& job, const FinishedGame& game) {
+    if (!write_file_atomically(this->get_path("done", game.job_id), finished_game_to_string(game)))
+        return false;
+
+    // The claim is moved to a hidden name before it is checked, so neither the
+    // coordinator nor a renewal can change it between the check and the removal
+    std::random_device random_device{};
+    const auto claimed_path = this->get_path("claimed", job.id);
+    const auto checked_path =
+        claimed_path.parent_path() / (".finish-" + claimed_path.filename().string() + '-' + std::to_string(random_device()));
+
+    std::error_code error;
+    std::filesystem::rename(claimed_path, checked_path, error);
+    if (error)
+        return true;
+
+    if (this->is_claimed_by(checked_path, job)) {
+        std::filesystem::remove(checked_path, error);
+    } else {
+        // The lease expired and another worker plays the job now
+        std::filesystem::rename(checked_path, claimed_path, error);
+    }
+
+    return true;
+}
+
+int WorkQueue::requeue_expired(std::chrono::seconds lease, int max_attempts) {
+    const auto now = std::filesystem::file_time_type::clock::now();
+
+    int requeued_count = 0;
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator{this->directory / "claimed", error}) {
+        const auto filename = entry.path().filename().string();
+        if (filename.starts_with("."))
+            continue;
+
+        const auto last_renewed = std::filesystem::last_write_time(entry.path(), error);
+        if (error || now - last_renewed < lease)
+            continue;
+
+        auto job = read_job(entry.path());
+
+        // The worker finished the job just before its lease ran out
+        if (job && std::filesystem::exists(this->get_path("done", job->id), error)) {
+            std::filesystem::remove(entry.path(), error);
+            continue;
+        }
+
+        if (!job || job->attempt + 1 >= max_attempts) {
+            std::filesystem::rename(entry.path(), this->directory / "failed" / filename, error);
+        } else {
+            job->attempt++;
+            job->claim_token.clear();
+
+            // The job is in both directories for a moment, a crash here only
+            // means that it is played once more
+            if (!this->enqueue(*job))
+                continue;
+
+            std::filesystem::remove(entry.path(), error);
+        }
+
+        requeued_count++;
+    }
+
+    return requeued_count;
+}
+
+WorkQueue::Counts WorkQueue::count() const {
+    Counts result{};
+
+    const auto count_files = [this](const char* state) {
+        int file_count = 0;
+
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator{this->directory / state, error}) {
+            if (!entry.path().filename().string().starts_with(".")) {
+                file_count++;
+            }
+        }
+
+        return file_count;
+    };
+
+    result.pending = count_files("pending");
+    result.claimed = count_files("claimed");
+    result.done = count_files("done");
+    result.failed = count_files("failed");
+
+    return result;
+}
+
+std::vector<FinishedGame> WorkQueue::read_finished_games() const {
+    std::vector<FinishedGame> result{};
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator{this->directory / "done", error}) {
+        if (entry.path().filename().string().starts_with("."))
+            continue;
+
+        if (auto game = read_finished_game(entry.path())) {
+            result.push_back(std::move(*game));
+        }
+    }
+
+    std::sort(
+        result.begin(), result.end(),
+        [](const FinishedGame& a, const FinishedGame& b) { return a.job_id < b.job_id; }
+    );
+
+    return result;
+}
+
+bool WorkQueue::is_claimed_by(const std::filesystem::path& path, const SelfPlayJob& job) const {
+    const auto claimed_job = read_job(path);
+    return claimed_job && claimed_job->claim_token == job.claim_token;
+}
+
+std::filesystem::path WorkQueue::get_path(const char* state, int job_id) const {
+    return this->directory / state / ("job-" + std::to_string(job_id));
+}
@@ -0,0 +1,96 @@
+#ifndef YINSH_SELFPLAY_WORK_QUEUE_HPP
+#define YINSH_SELFPLAY_WORK_QUEUE_HPP
+
+#include <yinsh-core/match.hpp>
+
+#include <yngine/moves.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct SelfPlayJob {
+    int id;
+    // Number of times the job was put back after a worker lost it
+    int attempt;
+    // Set by the worker that claimed the job, empty while it is pending
+    std::string claim_token;
+    EngineSettings white;
+    EngineSettings black;
+    std::vector<Yngine::Move> opening;
+};
+
+struct FinishedGame {
+    int job_id;
+    std::string worker;
+    float seconds;
+    EngineSettings white;
+    EngineSettings black;
+    GameRecord record;
+};
+
+// The same text that is stored in done/job-N
+std::string finished_game_to_string(const FinishedGame& game);
+
+// Jobs are files in a directory that every worker can reach, e.g. over NFS.
+// A job moves between the subdirectories with atomic renames, so a crash
+// at any point never loses a job, at worst it is played twice and the
+// later game replaces the earlier one:
+//   pending/job-N   waits for a worker
+//   claimed/job-N   is played, the worker touches it to renew its lease and
+//                   only removes it if it still holds its claim token
+//   done/job-N      holds the finished game
+//   failed/job-N    was lost by workers too many times
+class WorkQueue {
+public:
+    explicit WorkQueue(std::filesystem::path directory);
+
+    // Creates the directories and the jobs, the queue only becomes visible
+    // to workers after all of its jobs were written. Returns false if the
+    // queue already exists or can't be created
+    bool create(const std::vector<SelfPlayJob>& jobs);
+
+    // Returns nothing if the queue was not created
+    std::optional<int> get_game_count() const;
+
+    // Takes the next pending job, returns nothing if there are none
+    std::optional<SelfPlayJob> claim();
+
+    // Workers that stop renewing the claim of a job lose it after the lease time,
+    // a job that was claimed again by another worker is left alone
+    void renew(const SelfPlayJob& job);
+
+    // Stores the game and removes the claim, unless the job was put back and
+    // claimed by another worker in the meantime
+    bool finish(const SelfPlayJob& job, const FinishedGame& game);
+
+    // Puts the jobs whose lease expired back, or into failed/ when their lease
+    // expired for the max_attempts-th time, returns the number of such jobs.
+    // Leases compare the modification times set by the workers with the clock
+    // of the coordinator, so the machines need synchronized clocks
+    int requeue_expired(std::chrono::seconds lease, int max_attempts);
+
+    struct Counts {
+        int pending;
+        int claimed;
+        int done;
+        int failed;
+    };
+
+    Counts count() const;
+
+    std::vector<FinishedGame> read_finished_games() const;
+
+private:
+    bool enqueue(const SelfPlayJob& job);
+
+    bool is_claimed_by(const std::filesystem::path& path, const SelfPlayJob& job) const;
+
+    std::filesystem::path get_path(const char* state, int job_id) const;
+
+    std::filesystem::path directory;
+};
+
+#endif // YINSH_SELFPLAY_WORK_QUEUE_HPP
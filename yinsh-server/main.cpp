@@ -0,0 +1,107 @@
+#include <yinsh-server/server.hpp>
+#include <yinsh-core/system.hpp>
+
+#include <charconv>
+#include <cstdio>
+#include <string_view>
+
+static void print_usage(const char* program) {
+    std::fprintf(
+        stderr,
+        "Usage: %s [--socket PATH] [--port PORT] [--bind ADDRESS] [--threads N] [--memory MB]\n"
+        "          [--session-memory MB] [--session-max-memory MB] [--cache-size N]\n"
+        "          [--metrics-port PORT]\n"
+        "  --socket              path of the unix socket to listen on (default /tmp/yinsh.sock)\n"
+        "  --port                also serve the commands on this TCP port (default off)\n"
+        "  --bind                IPv4 address of the interface the TCP port is bound to, the port has\n"
+        "                        no authentication, e.g. 0.0.0.0 exposes it to the network (default 127.0.0.1)\n"
+        "  --threads             search threads shared by all sessions (default all system threads)\n"
+        "  --memory              search tree memory shared by all sessions (default half of the system memory)\n"
+        "  --session-memory      memory a session is promised for its tree (default 256)\n"
+        "  --session-max-memory  memory a session may use for its tree (default 2048)\n"
+        "  --cache-size          search results kept for repeated positions, 0 disables the cache (default 100000)\n"
+        "  --metrics-port        serve Prometheus metrics on this port of 127.0.0.1 (default off)\n",
+        program
+    );
+}
+
+static bool parse_non_negative(std::string_view text, int& result) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result);
+    return error == std::errc{} && end == text.data() + text.size() && result >= 0;
+}
+
+static bool parse_positive(std::string_view text, int& result) {
+    return parse_non_negative(text, result) && result > 0;
+}
+
+int main(int argc, char** argv) {
+    std::string socket_path = "/tmp/yinsh.sock";
+    int tcp_port = 0;
+    std::string tcp_bind_address = "127.0.0.1";
+    int thread_count = get_system_threads();
+    int memory_mb = static_cast<int>(get_system_memory() / 2 / 1024 / 1024);
+    int session_memory_mb = 256;
+    int session_max_memory_mb = 2048;
+    int cache_size = 100000;
+    int metrics_port = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view option = argv[i];
+
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        const std::string_view value = argv[++i];
+
+        bool is_valid = true;
+        if (option == "--socket") {
+            socket_path = value;
+        } else if (option == "--port") {
+            is_valid = parse_positive(value, tcp_port) && tcp_port <= 65535;
+        } else if (option == "--bind") {
+            tcp_bind_address = value;
+        } else if (option == "--threads") {
+            is_valid = parse_positive(value, thread_count);
+        } else if (option == "--memory") {
+            is_valid = parse_positive(value, memory_mb);
+        } else if (option == "--session-memory") {
+            is_valid = parse_positive(value, session_memory_mb);
+        } else if (option == "--session-max-memory") {
+            is_valid = parse_positive(value, session_max_memory_mb);
+        } else if (option == "--cache-size") {
+            is_valid = parse_non_negative(value, cache_size);
+        } else if (option == "--metrics-port") {
+            is_valid = parse_positive(value, metrics_port) && metrics_port <= 65535;
+        } else {
+            is_valid = false;
+        }
+
+        if (!is_valid) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (session_memory_mb > session_max_memory_mb) {
+        std::fprintf(stderr, "--session-memory can't be larger than --session-max-memory\n");
+        return 1;
+    }
+
+    constexpr std::size_t MB = 1024 * 1024;
+
+    Server server{Server::Options{
+        .socket_path = socket_path,
+        .tcp_port = static_cast<uint16_t>(tcp_port),
+        .tcp_bind_address = tcp_bind_address,
+        .thread_count = thread_count,
+        .total_memory = memory_mb * MB,
+        .session_soft_quota = session_memory_mb * MB,
+        .session_hard_quota = session_max_memory_mb * MB,
+        .cache_size = static_cast<std::size_t>(cache_size),
+        .metrics_port = static_cast<uint16_t>(metrics_port),
+    }};
+
+    return server.run() ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#include <yinsh-server/memory_pool.hpp>
+#include <yinsh-server/session.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+MemoryPool::MemoryPool(std::size_t total_memory)
+    : total_memory{total_memory}
+    , used_memory{0}
+    , sessions{} {
+}
+
+void MemoryPool::add_session(Session* session) {
+    std::lock_guard lock{this->mutex};
+
+    this->sessions.push_back(session);
+}
+
+void MemoryPool::remove_session(Session* session) {
+    std::lock_guard lock{this->mutex};
+
+    std::erase(this->sessions, session);
+}
+
+std::size_t MemoryPool::allocate(Session& session, std::size_t soft_quota, std::size_t hard_quota) {
+    assert(soft_quota <= hard_quota);
+
+    std::lock_guard lock{this->mutex};
+
+    if (this->total_memory - this->used_memory < soft_quota) {
+        this->reclaim(session, soft_quota);
+    }
+
+    const auto free_memory = this->total_memory - this->used_memory;
+    if (free_memory < soft_quota)
+        return 0;
+
+    const auto memory = std::min(free_memory, hard_quota);
+    this->used_memory += memory;
+
+    return memory;
+}
+
+void MemoryPool::free(std::size_t memory) {
+    std::lock_guard lock{this->mutex};
+
+    assert(memory <= this->used_memory);
+    this->used_memory -= memory;
+}
+
+std::size_t MemoryPool::get_total_memory() const {
+    return this->total_memory;
+}
+
+std::size_t MemoryPool::get_used_memory() {
+    std::lock_guard lock{this->mutex};
+
+    return this->used_memory;
+}
+
+void MemoryPool::reclaim(Session& requester, std::size_t needed_memory) {
+    auto candidates = this->sessions;
+    std::erase(candidates, &requester);
+
+    std::sort(
+        candidates.begin(),
+        candidates.end(),
+        [](const Session* lhs, const Session* rhs) {
+            return lhs->get_last_used() < rhs->get_last_used();
+        }
+    );
+
+    for (const auto session : candidates) {
+        if (this->total_memory - this->used_memory >= needed_memory)
+            break;
+
+        // Sessions that are busy right now are not idle and keep their trees
+        this->used_memory -= session->try_drop_tree();
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef YINSH_SERVER_MEMORY_POOL_HPP
+#define YINSH_SERVER_MEMORY_POOL_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+class Session;
+
+// Search tree memory shared by all sessions of the server. Every session may
+// use up to its hard quota, but is only promised its soft quota: when the pool
+// runs out, trees of idle sessions are dropped, least recently used first.
+// Engines get their memory when they are built, so a tree can only grow when
+// it is rebuilt.
+class MemoryPool {
+public:
+    explicit MemoryPool(std::size_t total_memory);
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    void add_session(Session* session);
+    void remove_session(Session* session);
+
+    // Returns the memory the session may build its tree with, or zero if
+    // the soft quota can't be satisfied even after reclaiming idle trees
+    std::size_t allocate(Session& session, std::size_t soft_quota, std::size_t hard_quota);
+    void free(std::size_t memory);
+
+    std::size_t get_total_memory() const;
+    std::size_t get_used_memory();
+
+private:
+    // Drops trees of idle sessions until there's enough free memory
+    void reclaim(Session& requester, std::size_t needed_memory);
+
+    std::mutex mutex;
+
+    std::size_t total_memory;
+    std::size_t used_memory;
+
+    std::vector<Session*> sessions;
+};
+
+#endif // YINSH_SERVER_MEMORY_POOL_HPP
@@ -0,0 +1,180 @@
+#include <yinsh-server/metrics.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct ThreadMetrics {
+    // Written only by the owning thread, so plain loads and stores are enough
+    std::array<std::atomic<uint64_t>, Metrics::COUNTER_COUNT> counters{};
+    std::array<std::atomic<uint64_t>, Metrics::LATENCY_BUCKETS.size() + 1> latency_buckets{};
+    std::atomic<uint64_t> latency_sum_us{0};
+};
+
+void add(std::atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// Metrics of the running threads, the ones of finished threads are added to
+// retired_metrics so that the counters never go back
+std::mutex thread_metrics_mutex;
+std::vector<ThreadMetrics*> thread_metrics;
+ThreadMetrics retired_metrics;
+
+void add_to(ThreadMetrics& sum, const ThreadMetrics& metrics) {
+    for (int i = 0; i < Metrics::COUNTER_COUNT; i++) {
+        add(sum.counters[i], metrics.counters[i].load(std::memory_order_relaxed));
+    }
+
+    for (std::size_t i = 0; i < sum.latency_buckets.size(); i++) {
+        add(sum.latency_buckets[i], metrics.latency_buckets[i].load(std::memory_order_relaxed));
+    }
+
+    add(sum.latency_sum_us, metrics.latency_sum_us.load(std::memory_order_relaxed));
+}
+
+// Registers the metrics of a thread while it runs, every connection has its own thread
+class ThreadRegistration {
+public:
+    ThreadRegistration() {
+        std::lock_guard lock{thread_metrics_mutex};
+        thread_metrics.push_back(&this->metrics);
+    }
+
+    ~ThreadRegistration() {
+        std::lock_guard lock{thread_metrics_mutex};
+
+        add_to(retired_metrics, this->metrics);
+        std::erase(thread_metrics, &this->metrics);
+    }
+
+    ThreadRegistration(const ThreadRegistration&) = delete;
+    ThreadRegistration& operator=(const ThreadRegistration&) = delete;
+
+    ThreadMetrics metrics;
+};
+
+ThreadMetrics& get_thread_metrics() {
+    thread_local ThreadRegistration registration{};
+    return registration.metrics;
+}
+
+}
+
+void Metrics::increment(Counter counter) {
+    add(get_thread_metrics().counters[static_cast<int>(counter)], 1);
+}
+
+void Metrics::observe_search_latency(double seconds) {
+    auto& metrics = get_thread_metrics();
+
+    std::size_t bucket = 0;
+    while (bucket < LATENCY_BUCKETS.size() && seconds > LATENCY_BUCKETS[bucket]) {
+        bucket++;
+    }
+
+    add(metrics.latency_buckets[bucket], 1);
+    add(metrics.latency_sum_us, static_cast<uint64_t>(seconds * 1e6));
+}
+
+Metrics::Snapshot Metrics::collect() {
+    ThreadMetrics sum{};
+
+    {
+        std::lock_guard lock{thread_metrics_mutex};
+
+        add_to(sum, retired_metrics);
+        for (const auto metrics : thread_metrics) {
+            add_to(sum, *metrics);
+        }
+    }
+
+    Snapshot result{};
+
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        result.counters[i] = sum.counters[i].load(std::memory_order_relaxed);
+    }
+
+    for (std::size_t i = 0; i < result.latency_buckets.size(); i++) {
+        result.latency_buckets[i] = sum.latency_buckets[i].load(std::memory_order_relaxed);
+    }
+
+    result.latency_sum = sum.latency_sum_us.load(std::memory_order_relaxed) / 1e6;
+
+    return result;
+}
+
+bool serve_metrics(uint16_t port, const std::function<std::string()>& render_metrics) {
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::perror("metrics socket");
+        return false;
+    }
+
+    const int reuse_address = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse_address, sizeof(reuse_address));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listener, SOMAXCONN) < 0) {
+        std::perror("metrics bind");
+        close(listener);
+        return false;
+    }
+
+    while (true) {
+        const int connection = accept(listener, nullptr, nullptr);
+
+        if (connection < 0) {
+            if (errno == EINTR)
+                continue;
+
+            std::perror("metrics accept");
+            break;
+        }
+
+        // Whatever was requested gets the metrics, the request itself doesn't matter
+        char request[4096];
+        recv(connection, request, sizeof(request), 0);
+
+        const auto body = render_metrics();
+        const auto response =
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "\r\n" + body;
+
+        std::size_t sent = 0;
+        while (sent < response.size()) {
+            const auto result = send(
+                connection,
+                response.data() + sent,
+                response.size() - sent,
+                MSG_NOSIGNAL
+            );
+
+            if (result <= 0)
+                break;
+
+            sent += result;
+        }
+
+        close(connection);
+    }
+
+    close(listener);
+    return false;
+}
@@ -0,0 +1,44 @@
+#ifndef YINSH_SERVER_METRICS_HPP
+#define YINSH_SERVER_METRICS_HPP
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Counters of the server. Every thread updates its own copy of them without
+// synchronizing with others, the copies are only added up when scraped
+class Metrics {
+public:
+    enum class Counter {
+        Searches,
+        CachedSearches,
+        LegalityChecks,
+        IllegalMoves,
+    };
+
+    static constexpr int COUNTER_COUNT = 4;
+
+    static constexpr std::array<double, 11> LATENCY_BUCKETS = {
+        0.01, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60
+    };
+
+    struct Snapshot {
+        std::array<uint64_t, COUNTER_COUNT> counters;
+
+        // Not cumulative, the last bucket counts the searches slower than all the bounds
+        std::array<uint64_t, LATENCY_BUCKETS.size() + 1> latency_buckets;
+        double latency_sum;
+    };
+
+    static void increment(Counter counter);
+    static void observe_search_latency(double seconds);
+
+    static Snapshot collect();
+};
+
+// Serves the text returned by render_metrics over HTTP on the loopback
+// interface in the Prometheus exposition format. Returns only on errors
+bool serve_metrics(uint16_t port, const std::function<std::string()>& render_metrics);
+
+#endif // YINSH_SERVER_METRICS_HPP
@@ -0,0 +1,68 @@
+#include <yinsh-server/result_cache.hpp>
+
+float ResultCache::Result::get_thread_seconds() const {
+    return this->seconds * this->threads;
+}
+
+ResultCache::ResultCache(std::size_t capacity)
+    : shard_capacity{(capacity + SHARD_COUNT - 1) / SHARD_COUNT}
+    , shards{} {
+}
+
+std::optional<ResultCache::Result> ResultCache::find(uint64_t hash) {
+    auto& shard = this->get_shard(hash);
+    std::lock_guard lock{shard.mutex};
+
+    const auto index = shard.entry_indices.find(hash);
+    if (index == shard.entry_indices.end())
+        return std::nullopt;
+
+    auto& entry = shard.entries[index->second];
+    entry.referenced = true;
+
+    return entry.result;
+}
+
+void ResultCache::insert(uint64_t hash, Result result) {
+    if (this->shard_capacity == 0)
+        return;
+
+    auto& shard = this->get_shard(hash);
+    std::lock_guard lock{shard.mutex};
+
+    const auto index = shard.entry_indices.find(hash);
+    if (index != shard.entry_indices.end()) {
+        auto& entry = shard.entries[index->second];
+
+        if (result.get_thread_seconds() >= entry.result.get_thread_seconds()) {
+            entry.result = result;
+        }
+
+        entry.referenced = true;
+        return;
+    }
+
+    if (shard.entries.size() < this->shard_capacity) {
+        shard.entry_indices.emplace(hash, shard.entries.size());
+        shard.entries.push_back(Entry{hash, result, false});
+        return;
+    }
+
+    // Give every entry that was used since the last pass a second chance
+    while (shard.entries[shard.clock_hand].referenced) {
+        shard.entries[shard.clock_hand].referenced = false;
+        shard.clock_hand = (shard.clock_hand + 1) % shard.entries.size();
+    }
+
+    auto& victim = shard.entries[shard.clock_hand];
+    shard.entry_indices.erase(victim.hash);
+    shard.entry_indices.emplace(hash, shard.clock_hand);
+    victim = Entry{hash, result, false};
+
+    shard.clock_hand = (shard.clock_hand + 1) % shard.entries.size();
+}
+
+ResultCache::Shard& ResultCache::get_shard(uint64_t hash) {
+    // The low bits pick the bucket inside the shard's map, so use the high ones here
+    return this->shards[(hash >> 60) % SHARD_COUNT];
+}
@@ -0,0 +1,64 @@
+#ifndef YINSH_SERVER_RESULT_CACHE_HPP
+#define YINSH_SERVER_RESULT_CACHE_HPP
+
+#include <yngine/moves.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Results of finished searches shared by all sessions, keyed by the canonical
+// position hash. The cache is split into shards with their own locks, and each
+// shard evicts with the CLOCK algorithm once it's full
+class ResultCache {
+public:
+    struct Result {
+        // In the orientation of the canonical position
+        Yngine::Move best_move;
+
+        // Budget the move was actually searched with, which is less than the
+        // requested one when the search waited for threads past its deadline
+        float seconds;
+        int threads;
+
+        // Results are compared by this, more threads count as more time
+        float get_thread_seconds() const;
+    };
+
+    // Zero capacity disables the cache
+    explicit ResultCache(std::size_t capacity);
+
+    std::optional<Result> find(uint64_t hash);
+
+    // Keeps the result searched with the larger budget if the position is already cached
+    void insert(uint64_t hash, Result result);
+
+private:
+    struct Entry {
+        uint64_t hash;
+        Result result;
+        bool referenced;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+
+        std::vector<Entry> entries;
+        std::unordered_map<uint64_t, std::size_t> entry_indices;
+
+        std::size_t clock_hand = 0;
+    };
+
+    static constexpr std::size_t SHARD_COUNT = 16;
+
+    Shard& get_shard(uint64_t hash);
+
+    std::size_t shard_capacity;
+    std::array<Shard, SHARD_COUNT> shards;
+};
+
+#endif // YINSH_SERVER_RESULT_CACHE_HPP
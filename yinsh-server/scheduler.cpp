@@ -0,0 +1,117 @@
+#include <yinsh-server/scheduler.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// Searches that waited past their deadline still have to return a move
+static constexpr float MIN_SEARCH_SECONDS = 0.05f;
+
+SearchScheduler::SearchScheduler(int total_threads)
+    : total_threads{total_threads}
+    , free_threads{total_threads}
+    , session_count{1}
+    , waiting{}
+    , running_time_budget{0}
+    , next_ticket{0} {
+    assert(total_threads > 0);
+}
+
+SearchScheduler::Grant SearchScheduler::acquire(float time_budget, Clock::time_point deadline) {
+    std::unique_lock lock{this->mutex};
+
+    const auto ticket = this->next_ticket++;
+    this->waiting.push_back(Request{ticket, time_budget, deadline});
+
+    this->threads_released.wait(lock, [this, ticket] {
+        return this->free_threads > 0 && this->is_first_in_line(ticket);
+    });
+
+    float total_time_budget = this->running_time_budget;
+    for (const auto& request : this->waiting) {
+        total_time_budget += request.time_budget;
+    }
+
+    int threads = static_cast<int>(std::round(
+        this->total_threads * (time_budget / total_time_budget)
+    ));
+    const int fair_share = std::max(1, this->total_threads / this->session_count);
+    threads = std::clamp(threads, 1, std::min(this->free_threads, fair_share));
+
+    std::erase_if(this->waiting, [ticket](const Request& request) {
+        return request.ticket == ticket;
+    });
+
+    this->free_threads -= threads;
+    this->running_time_budget += time_budget;
+
+    // The next search in line might fit into the threads that are left
+    if (this->free_threads > 0 && !this->waiting.empty()) {
+        this->threads_released.notify_all();
+    }
+
+    const auto seconds_left =
+        std::chrono::duration<float>(deadline - Clock::now()).count();
+
+    return Grant{
+        threads,
+        std::max(seconds_left, MIN_SEARCH_SECONDS),
+        time_budget,
+    };
+}
+
+void SearchScheduler::release(Grant grant) {
+    {
+        std::lock_guard lock{this->mutex};
+
+        this->free_threads += grant.threads;
+        this->running_time_budget -= grant.time_budget;
+
+        assert(this->free_threads <= this->total_threads);
+    }
+
+    this->threads_released.notify_all();
+}
+
+void SearchScheduler::set_session_count(int session_count) {
+    std::lock_guard lock{this->mutex};
+
+    this->session_count = std::max(session_count, 1);
+}
+
+int SearchScheduler::get_fair_share() {
+    std::lock_guard lock{this->mutex};
+
+    return std::max(1, this->total_threads / this->session_count);
+}
+
+int SearchScheduler::get_total_threads() const {
+    return this->total_threads;
+}
+
+int SearchScheduler::get_free_threads() {
+    std::lock_guard lock{this->mutex};
+
+    return this->free_threads;
+}
+
+int SearchScheduler::get_waiting_count() {
+    std::lock_guard lock{this->mutex};
+
+    return static_cast<int>(this->waiting.size());
+}
+
+bool SearchScheduler::is_first_in_line(uint64_t ticket) const {
+    const auto first = std::min_element(
+        this->waiting.begin(),
+        this->waiting.end(),
+        [](const Request& lhs, const Request& rhs) {
+            if (lhs.deadline != rhs.deadline)
+                return lhs.deadline < rhs.deadline;
+
+            return lhs.ticket < rhs.ticket;
+        }
+    );
+
+    return first != this->waiting.end() && first->ticket == ticket;
+}
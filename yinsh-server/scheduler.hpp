@@ -0,0 +1,66 @@
+#ifndef YINSH_SERVER_SCHEDULER_HPP
+#define YINSH_SERVER_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Shares a fixed number of threads between the searches of all sessions.
+// The engine runs every search on its own worker threads, so instead of
+// handing out tasks the scheduler decides when a search may start and how
+// many threads it gets. The sum of granted threads never exceeds the total.
+class SearchScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Grant {
+        int threads;
+        // Time the search may run for to finish before its deadline
+        float seconds;
+        float time_budget;
+    };
+
+    explicit SearchScheduler(int total_threads);
+
+    // Blocks until the search may start. Searches are started in the order of
+    // their deadlines, and the free threads are divided between the waiting
+    // and running searches in proportion to their time budgets. Grants are
+    // never rebalanced, so a search gets at most its fair share of the threads
+    // among the sessions, which leaves threads for the searches that come later
+    Grant acquire(float time_budget, Clock::time_point deadline);
+    void release(Grant grant);
+
+    // Sessions that may search at the same time, divides the fair share
+    void set_session_count(int session_count);
+
+    // Threads that a search of any session may get at most
+    int get_fair_share();
+
+    int get_total_threads() const;
+    int get_free_threads();
+    int get_waiting_count();
+
+private:
+    struct Request {
+        uint64_t ticket;
+        float time_budget;
+        Clock::time_point deadline;
+    };
+
+    bool is_first_in_line(uint64_t ticket) const;
+
+    std::mutex mutex;
+    std::condition_variable threads_released;
+
+    int total_threads;
+    int free_threads;
+    int session_count;
+
+    std::vector<Request> waiting;
+    float running_time_budget;
+    uint64_t next_ticket;
+};
+
+#endif // YINSH_SERVER_SCHEDULER_HPP
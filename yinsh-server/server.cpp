@@ -0,0 +1,452 @@
+#include <yinsh-server/server.hpp>
+#include <yinsh-server/metrics.hpp>
+#include <yinsh-core/notation.hpp>
+#include <yinsh-core/system.hpp>
+#include <yinsh-core/utils.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+static const char* next_action_to_string(BoardState::NextAction next_action) {
+    switch (next_action) {
+    case BoardState::NextAction::RingPlacement:
+        return "ring-placement";
+    case BoardState::NextAction::RingMovement:
+        return "ring-movement";
+    case BoardState::NextAction::RowRemoval:
+        return "row-removal";
+    case BoardState::NextAction::RingRemoval:
+        return "ring-removal";
+    case BoardState::NextAction::GameOver:
+        return "game-over";
+    default:
+        abort();
+    }
+}
+
+static bool send_line(int connection, const std::string& line) {
+    const auto message = line + '\n';
+
+    std::size_t sent = 0;
+    while (sent < message.size()) {
+        const auto result = send(
+            connection,
+            message.data() + sent,
+            message.size() - sent,
+            MSG_NOSIGNAL
+        );
+
+        if (result <= 0)
+            return false;
+
+        sent += result;
+    }
+
+    return true;
+}
+
+Server::Server(Options options)
+    : socket_path{std::move(options.socket_path)}
+    , tcp_port{options.tcp_port}
+    , tcp_bind_address{std::move(options.tcp_bind_address)}
+    , metrics_port{options.metrics_port}
+    , session_soft_quota{options.session_soft_quota}
+    , session_hard_quota{options.session_hard_quota}
+    , scheduler{options.thread_count}
+    , memory_pool{options.total_memory}
+    , result_cache{options.cache_size}
+    , sessions{}
+    , next_session_id{1} {
+}
+
+bool Server::run() {
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::perror("socket");
+        return false;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (this->socket_path.size() >= sizeof(address.sun_path)) {
+        std::fprintf(stderr, "Socket path is too long: %s\n", this->socket_path.c_str());
+        close(listener);
+        return false;
+    }
+
+    std::strcpy(address.sun_path, this->socket_path.c_str());
+
+    // Remove the socket left by a previous run
+    unlink(this->socket_path.c_str());
+
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listener, SOMAXCONN) < 0) {
+        std::perror("bind");
+        close(listener);
+        return false;
+    }
+
+    if (this->tcp_port != 0) {
+        const int tcp_listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (tcp_listener < 0) {
+            std::perror("tcp socket");
+            close(listener);
+            return false;
+        }
+
+        const int reuse_address = 1;
+        setsockopt(tcp_listener, SOL_SOCKET, SO_REUSEADDR, &reuse_address, sizeof(reuse_address));
+
+        sockaddr_in tcp_address{};
+        tcp_address.sin_family = AF_INET;
+        tcp_address.sin_port = htons(this->tcp_port);
+
+        if (inet_pton(AF_INET, this->tcp_bind_address.c_str(), &tcp_address.sin_addr) != 1) {
+            std::fprintf(stderr, "Invalid bind address: %s\n", this->tcp_bind_address.c_str());
+            close(tcp_listener);
+            close(listener);
+            return false;
+        }
+
+        if (bind(tcp_listener, reinterpret_cast<sockaddr*>(&tcp_address), sizeof(tcp_address)) < 0 ||
+            listen(tcp_listener, SOMAXCONN) < 0) {
+            std::perror("tcp bind");
+            close(tcp_listener);
+            close(listener);
+            return false;
+        }
+
+        std::thread{[this, tcp_listener] {
+            this->accept_connections(tcp_listener);
+            close(tcp_listener);
+        }}.detach();
+
+        std::printf("Listening on TCP port %i of %s\n", this->tcp_port, this->tcp_bind_address.c_str());
+    }
+
+    if (this->metrics_port != 0) {
+        std::thread{[this] {
+            serve_metrics(this->metrics_port, [this] { return this->render_metrics(); });
+        }}.detach();
+
+        std::printf("Serving metrics on http://127.0.0.1:%i/metrics\n", this->metrics_port);
+    }
+
+    std::printf(
+        "Listening on %s with %i search threads and %zu MB of tree memory\n",
+        this->socket_path.c_str(),
+        this->scheduler.get_total_threads(),
+        this->memory_pool.get_total_memory() / 1024 / 1024
+    );
+
+    this->accept_connections(listener);
+
+    close(listener);
+    unlink(this->socket_path.c_str());
+
+    return false;
+}
+
+void Server::accept_connections(int listener) {
+    while (true) {
+        const int connection = accept(listener, nullptr, nullptr);
+
+        if (connection < 0) {
+            if (errno == EINTR)
+                continue;
+
+            std::perror("accept");
+            break;
+        }
+
+        std::thread{&Server::serve_connection, this, connection}.detach();
+    }
+}
+
+void Server::serve_connection(int connection) {
+    // Answers are single short lines, don't hold them back on TCP connections
+    const int no_delay = 1;
+    setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+    std::string buffer{};
+    char chunk[4096];
+
+    while (true) {
+        const auto received = recv(connection, chunk, sizeof(chunk), 0);
+        if (received <= 0)
+            break;
+
+        buffer.append(chunk, received);
+
+        bool keep_connection = true;
+
+        std::size_t line_end;
+        while (keep_connection && (line_end = buffer.find('\n')) != std::string::npos) {
+            auto line = buffer.substr(0, line_end);
+            buffer.erase(0, line_end + 1);
+
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+
+            if (line.empty())
+                continue;
+
+            if (line == "quit") {
+                keep_connection = false;
+                break;
+            }
+
+            keep_connection = send_line(connection, this->execute(line));
+        }
+
+        if (!keep_connection)
+            break;
+    }
+
+    close(connection);
+}
+
+std::string Server::execute(const std::string& command_line) {
+    std::istringstream stream{command_line};
+
+    std::string command;
+    stream >> command;
+
+    if (command == "new") {
+        auto hard_quota = this->session_hard_quota;
+
+        std::size_t hard_quota_mb;
+        if (stream >> hard_quota_mb) {
+            if (hard_quota_mb == 0)
+                return "error memory limit must be positive";
+
+            // A session may ask for less memory than the server allows, never more
+            if (hard_quota_mb > this->session_hard_quota / 1024 / 1024)
+                return "error memory limit is above the session maximum";
+
+            hard_quota = hard_quota_mb * 1024 * 1024;
+        }
+
+        const auto soft_quota = std::min(this->session_soft_quota, hard_quota);
+
+        std::lock_guard lock{this->sessions_mutex};
+
+        const auto id = this->next_session_id++;
+        this->sessions.emplace(
+            id,
+            std::make_shared<Session>(id, this->memory_pool, soft_quota, hard_quota)
+        );
+        this->scheduler.set_session_count(static_cast<int>(this->sessions.size()));
+
+        return "ok " + std::to_string(id);
+    }
+
+    if (command == "stats") {
+        std::ostringstream result;
+        result << "ok";
+
+        if (const auto process_memory = get_process_memory()) {
+            result << " resident=" << process_memory->resident;
+
+            if (process_memory->proportional) {
+                result << " proportional=" << *process_memory->proportional;
+            }
+        }
+
+        result << " tree-memory=" << this->memory_pool.get_used_memory();
+        result << " tree-memory-limit=" << this->memory_pool.get_total_memory();
+
+        std::lock_guard lock{this->sessions_mutex};
+        result << " sessions=" << this->sessions.size();
+
+        return result.str();
+    }
+
+    int id;
+    if (!(stream >> id))
+        return "error expected a session id";
+
+    if (command == "close") {
+        std::lock_guard lock{this->sessions_mutex};
+
+        if (this->sessions.erase(id) == 0)
+            return "error unknown session";
+
+        this->scheduler.set_session_count(static_cast<int>(this->sessions.size()));
+
+        return "ok";
+    }
+
+    // Sessions are shared so that closing one doesn't pull it
+    // from under a command that is still running
+    const auto session = this->find_session(id);
+    if (!session)
+        return "error unknown session";
+
+    if (command == "play") {
+        const auto move = parse_move(stream);
+        if (!move)
+            return "error malformed move";
+
+        if (!session->play(*move))
+            return "error illegal move";
+
+        return "ok";
+    } else if (command == "go") {
+        float seconds;
+        if (!(stream >> seconds) || !(seconds > 0))
+            return "error expected a positive search time";
+
+        const auto result = session->search(this->scheduler, this->result_cache, seconds);
+
+        return std::visit(variant_overloaded{
+            [](Yngine::Move move) -> std::string {
+                return "bestmove " + move_to_string(move);
+            },
+            [](Session::SearchError error) -> std::string {
+                switch (error) {
+                case Session::SearchError::GameIsOver:
+                    return "error game is over";
+                case Session::SearchError::OutOfMemory:
+                    return "error out of memory";
+                default:
+                    abort();
+                }
+            },
+        }, result);
+    } else if (command == "state") {
+        const auto board_state = session->get_board_state();
+
+        return std::string{"ok "} +
+            next_action_to_string(board_state.get_next_action()) +
+            (board_state.is_whites_move() ? " white" : " black");
+    }
+
+    return "error unknown command";
+}
+
+std::string Server::render_metrics() {
+    std::ostringstream result;
+
+    const auto write_metric = [&result](
+        const char* name,
+        const char* type,
+        const char* help,
+        auto value
+    ) {
+        result << "# HELP " << name << ' ' << help << '\n';
+        result << "# TYPE " << name << ' ' << type << '\n';
+        result << name << ' ' << value << '\n';
+    };
+
+    const auto metrics = Metrics::collect();
+    const auto counter = [&metrics](Metrics::Counter counter) {
+        return metrics.counters[static_cast<int>(counter)];
+    };
+
+    write_metric(
+        "yinsh_searches_total", "counter",
+        "Searches run by the engine",
+        counter(Metrics::Counter::Searches)
+    );
+    write_metric(
+        "yinsh_cached_searches_total", "counter",
+        "Searches answered from the result cache",
+        counter(Metrics::Counter::CachedSearches)
+    );
+    write_metric(
+        "yinsh_legality_checks_total", "counter",
+        "Moves checked for legality",
+        counter(Metrics::Counter::LegalityChecks)
+    );
+    write_metric(
+        "yinsh_illegal_moves_total", "counter",
+        "Moves rejected as illegal",
+        counter(Metrics::Counter::IllegalMoves)
+    );
+
+    result << "# HELP yinsh_search_duration_seconds Time from a search request to its move, including waiting for threads\n";
+    result << "# TYPE yinsh_search_duration_seconds histogram\n";
+
+    uint64_t cumulative_count = 0;
+    for (std::size_t i = 0; i < metrics.latency_buckets.size(); i++) {
+        cumulative_count += metrics.latency_buckets[i];
+
+        result << "yinsh_search_duration_seconds_bucket{le=\"";
+        if (i < Metrics::LATENCY_BUCKETS.size()) {
+            result << Metrics::LATENCY_BUCKETS[i];
+        } else {
+            result << "+Inf";
+        }
+        result << "\"} " << cumulative_count << '\n';
+    }
+
+    result << "yinsh_search_duration_seconds_sum " << metrics.latency_sum << '\n';
+    result << "yinsh_search_duration_seconds_count " << cumulative_count << '\n';
+
+    std::size_t session_count;
+    {
+        std::lock_guard lock{this->sessions_mutex};
+        session_count = this->sessions.size();
+    }
+
+    write_metric(
+        "yinsh_sessions", "gauge",
+        "Open sessions",
+        session_count
+    );
+    write_metric(
+        "yinsh_waiting_searches", "gauge",
+        "Searches waiting for threads",
+        this->scheduler.get_waiting_count()
+    );
+    write_metric(
+        "yinsh_busy_search_threads", "gauge",
+        "Threads given to running searches",
+        this->scheduler.get_total_threads() - this->scheduler.get_free_threads()
+    );
+    write_metric(
+        "yinsh_tree_memory_bytes", "gauge",
+        "Memory given to the search trees of sessions",
+        this->memory_pool.get_used_memory()
+    );
+    write_metric(
+        "yinsh_tree_memory_limit_bytes", "gauge",
+        "Memory available for the search trees of all sessions",
+        this->memory_pool.get_total_memory()
+    );
+
+    // Scrapes are frequent, the proportional memory is only in the stats command
+    if (const auto resident_memory = get_resident_memory()) {
+        write_metric(
+            "yinsh_resident_memory_bytes", "gauge",
+            "Resident memory of the server process",
+            *resident_memory
+        );
+    }
+
+    return result.str();
+}
+
+std::shared_ptr<Session> Server::find_session(int id) {
+    std::lock_guard lock{this->sessions_mutex};
+
+    const auto session = this->sessions.find(id);
+    if (session == this->sessions.end())
+        return nullptr;
+
+    return session->second;
+}
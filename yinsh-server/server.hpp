@@ -0,0 +1,82 @@
+#ifndef YINSH_SERVER_SERVER_HPP
+#define YINSH_SERVER_SERVER_HPP
+
+#include <yinsh-server/memory_pool.hpp>
+#include <yinsh-server/result_cache.hpp>
+#include <yinsh-server/scheduler.hpp>
+#include <yinsh-server/session.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Hosts many games over a local socket and optionally a TCP port. Every connection is served by its own
+// thread and may drive any number of sessions, one command per line:
+//   new [hard quota in MB]    -> ok <session id>
+//   play <session id> <move>  -> ok
+//   go <session id> <seconds> -> bestmove <move>
+//   state <session id>        -> ok <next action> <white|black>
+//   close <session id>        -> ok
+//   stats                     -> ok <key>=<value> ...
+//   quit
+// Failed commands are answered with "error <reason>"
+class Server {
+public:
+    struct Options {
+        std::string socket_path;
+        // The same commands are served on this TCP port, e.g. for Yinsh-cluster
+        // on other machines, zero disables it. The port has no authentication,
+        // so it is only bound to other interfaces than loopback when asked to
+        uint16_t tcp_port;
+        // IPv4 address of the interface the TCP port is bound to
+        std::string tcp_bind_address;
+        int thread_count;
+
+        // Memory for the search trees of all sessions together
+        std::size_t total_memory;
+        std::size_t session_soft_quota;
+        std::size_t session_hard_quota;
+
+        // Number of search results kept for repeated positions
+        std::size_t cache_size;
+
+        // Prometheus metrics are served on this port of the loopback
+        // interface, zero disables them
+        uint16_t metrics_port;
+    };
+
+    explicit Server(Options options);
+
+    // Serves connections until the process is stopped,
+    // returns false if the socket could not be set up
+    bool run();
+
+private:
+    void accept_connections(int listener);
+    void serve_connection(int connection);
+    std::string execute(const std::string& command_line);
+
+    std::string render_metrics();
+
+    std::shared_ptr<Session> find_session(int id);
+
+    std::string socket_path;
+    uint16_t tcp_port;
+    std::string tcp_bind_address;
+    uint16_t metrics_port;
+    std::size_t session_soft_quota;
+    std::size_t session_hard_quota;
+
+    SearchScheduler scheduler;
+    MemoryPool memory_pool;
+    ResultCache result_cache;
+
+    std::mutex sessions_mutex;
+    std::unordered_map<int, std::shared_ptr<Session>> sessions;
+    int next_session_id;
+};
+
+#endif // YINSH_SERVER_SERVER_HPP
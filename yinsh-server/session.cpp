@@ -0,0 +1,152 @@
+#include <yinsh-server/session.hpp>
+#include <yinsh-server/metrics.hpp>
+
+static constexpr float FULL_SEARCH_FRACTION = 0.95f;
+
+Session::Session(int id, MemoryPool& memory_pool, std::size_t soft_quota, std::size_t hard_quota)
+    : id{id}
+    , board_state{}
+    , history{}
+    , memory_pool{memory_pool}
+    , soft_quota{soft_quota}
+    , hard_quota{hard_quota}
+    , engine{}
+    , engine_memory{0}
+    , last_used{SearchScheduler::Clock::now()} {
+    this->memory_pool.add_session(this);
+}
+
+Session::~Session() {
+    this->memory_pool.remove_session(this);
+
+    if (this->engine) {
+        this->memory_pool.free(this->engine_memory);
+    }
+}
+
+int Session::get_id() const {
+    return this->id;
+}
+
+bool Session::play(Yngine::Move move) {
+    std::lock_guard lock{this->mutex};
+
+    Metrics::increment(Metrics::Counter::LegalityChecks);
+
+    if (!this->board_state.is_move_legal(move)) {
+        Metrics::increment(Metrics::Counter::IllegalMoves);
+        return false;
+    }
+
+    this->board_state.apply_move(move);
+    this->history.push_back(move);
+
+    if (this->engine) {
+        this->engine->apply_move(move);
+    }
+
+    this->last_used = SearchScheduler::Clock::now();
+
+    return true;
+}
+
+std::variant<Yngine::Move, Session::SearchError> Session::search(
+    SearchScheduler& scheduler,
+    ResultCache& result_cache,
+    float seconds
+) {
+    const auto start = SearchScheduler::Clock::now();
+
+    std::lock_guard lock{this->mutex};
+
+    if (this->board_state.get_next_action() == BoardState::NextAction::GameOver)
+        return SearchError::GameIsOver;
+
+    this->last_used = start;
+
+    const auto canonical = this->board_state.get_canonical();
+    const auto from_canonical = canonical.symmetry.inverse();
+
+    // The cached search must have had at least as many thread-seconds as this
+    // one could get, so a search cut short by its deadline doesn't answer a full one
+    const auto requested_thread_seconds = seconds * scheduler.get_fair_share();
+
+    if (const auto cached = result_cache.find(canonical.hash);
+        cached && cached->get_thread_seconds() >= requested_thread_seconds) {
+        const auto move = from_canonical.apply(cached->best_move);
+
+        // Guards against hash collisions
+        if (this->board_state.is_move_legal(move)) {
+            Metrics::increment(Metrics::Counter::CachedSearches);
+            return move;
+        }
+    }
+
+    if (!this->engine) {
+        const auto memory = this->memory_pool.allocate(*this, this->soft_quota, this->hard_quota);
+        if (memory == 0)
+            return SearchError::OutOfMemory;
+
+        this->engine.emplace(memory);
+        this->engine_memory = memory;
+
+        for (const auto move : this->history) {
+            this->engine->apply_move(move);
+        }
+    }
+
+    const auto deadline = SearchScheduler::Clock::now() +
+        std::chrono::duration_cast<SearchScheduler::Clock::duration>(
+            std::chrono::duration<float>(seconds)
+        );
+
+    const auto grant = scheduler.acquire(seconds, deadline);
+    const auto move = this->engine->search(grant.seconds, grant.threads).get();
+    scheduler.release(grant);
+
+    // The deadline is set before waiting for threads, so even a search that
+    // didn't wait gets a little less than it asked for. Only a search that
+    // lost a noticeable part of its time is cached with the shorter time
+    const auto searched_seconds =
+        grant.seconds >= seconds * FULL_SEARCH_FRACTION ? seconds : grant.seconds;
+
+    result_cache.insert(canonical.hash, ResultCache::Result{
+        canonical.symmetry.apply(move),
+        searched_seconds,
+        grant.threads,
+    });
+
+    this->last_used = SearchScheduler::Clock::now();
+
+    // Includes the time spent waiting for threads
+    Metrics::increment(Metrics::Counter::Searches);
+    Metrics::observe_search_latency(
+        std::chrono::duration<double>(this->last_used.load() - start).count()
+    );
+
+    return move;
+}
+
+BoardState Session::get_board_state() {
+    std::lock_guard lock{this->mutex};
+
+    return this->board_state;
+}
+
+SearchScheduler::Clock::time_point Session::get_last_used() const {
+    return this->last_used;
+}
+
+std::size_t Session::try_drop_tree() {
+    std::unique_lock lock{this->mutex, std::try_to_lock};
+
+    if (!lock || !this->engine)
+        return 0;
+
+    this->engine.reset();
+
+    const auto freed_memory = this->engine_memory;
+    this->engine_memory = 0;
+
+    return freed_memory;
+}
@@ -0,0 +1,73 @@
+#ifndef YINSH_SERVER_SESSION_HPP
+#define YINSH_SERVER_SESSION_HPP
+
+#include <yinsh-server/memory_pool.hpp>
+#include <yinsh-server/result_cache.hpp>
+#include <yinsh-server/scheduler.hpp>
+#include <yinsh-core/board.hpp>
+
+#include <yngine/mcts.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <variant>
+#include <vector>
+
+// One game hosted by the server, it owns the position and the search tree
+class Session {
+public:
+    enum class SearchError {
+        GameIsOver,
+        OutOfMemory,
+    };
+
+    Session(int id, MemoryPool& memory_pool, std::size_t soft_quota, std::size_t hard_quota);
+    ~Session();
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    int get_id() const;
+
+    // Returns false if the move is illegal in the current position
+    bool play(Yngine::Move move);
+
+    // Answers from the cache if the position was searched
+    // with at least as much time before
+    std::variant<Yngine::Move, SearchError> search(
+        SearchScheduler& scheduler,
+        ResultCache& result_cache,
+        float seconds
+    );
+
+    BoardState get_board_state();
+
+    SearchScheduler::Clock::time_point get_last_used() const;
+
+    // Frees the search tree unless the session is busy, returns the freed memory.
+    // The tree is rebuilt from the game history on the next search
+    std::size_t try_drop_tree();
+
+private:
+    int id;
+
+    // Commands for the same session are executed one at a time,
+    // a search holds the lock until it's finished
+    std::mutex mutex;
+
+    BoardState board_state;
+    std::vector<Yngine::Move> history;
+
+    MemoryPool& memory_pool;
+    std::size_t soft_quota;
+    std::size_t hard_quota;
+
+    // Not null while the session holds memory from the pool
+    std::optional<Yngine::MCTS> engine;
+    std::size_t engine_memory;
+
+    std::atomic<SearchScheduler::Clock::time_point> last_used;
+};
+
+#endif // YINSH_SERVER_SESSION_HPP
@@ -0,0 +1,146 @@
+#include <yinsh-core/board.hpp>
+
+#include <yngine/mcts.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string_view>
+
+#if defined(EMSCRIPTEN) && defined(__wasm_simd128__)
+static constexpr const char* BUILD_NAME = "wasm-simd";
+#elif defined(EMSCRIPTEN)
+static constexpr const char* BUILD_NAME = "wasm";
+#else
+static constexpr const char* BUILD_NAME = "native";
+#endif
+
+static void print_usage(const char* program) {
+    std::fprintf(
+        stderr,
+        "Usage: %s [--seconds S] [--memory MB]\n"
+        "  --seconds  time spent on the playouts (default 2)\n"
+        "  --memory   search tree memory of the engine (default 1024)\n",
+        program
+    );
+}
+
+static bool parse_positive(std::string_view text, int& result) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result);
+    return error == std::errc{} && end == text.data() + text.size() && result > 0;
+}
+
+static bool parse_positive(const char* text, float& result) {
+    char* end;
+    result = std::strtof(text, &end);
+    return end != text && *end == '\0' && result > 0;
+}
+
+using Clock = std::chrono::steady_clock;
+
+struct PlayoutSpeed {
+    double playouts_per_second;
+    // Calls of get_legal_moves, one for every ply, and the moves they returned
+    double generations_per_second;
+    double moves_per_second;
+};
+
+// Random games from the initial position, the same work the rollouts of a
+// search do. The moves are picked with a plain modulo like the reference
+// positions of Yinsh-bench, so every build plays the same games
+static PlayoutSpeed measure_playouts(float seconds) {
+    std::mt19937 random{1};
+
+    long long playout_count = 0, generation_count = 0, move_count = 0;
+
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::duration<float>(seconds);
+
+    while (Clock::now() < end) {
+        BoardState board_state{};
+
+        while (board_state.get_next_action() != BoardState::NextAction::GameOver) {
+            const auto legal_moves = board_state.get_legal_moves();
+            generation_count++;
+            move_count += legal_moves.size();
+
+            board_state.apply_move(legal_moves[random() % legal_moves.size()]);
+        }
+
+        playout_count++;
+    }
+
+    const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    return PlayoutSpeed{
+        playout_count / elapsed,
+        generation_count / elapsed,
+        move_count / elapsed,
+    };
+}
+
+struct EngineSpeed {
+    // Creating the engine commits its memory and the first search starts its
+    // threads, both are much slower on the web
+    double startup_ms;
+};
+
+// Yngine doesn't report its iterations and its searches run for the time
+// they are given, so only the startup of the engine can be compared
+static EngineSpeed measure_engine(std::size_t memory_limit) {
+    const auto construction_start = Clock::now();
+
+    Yngine::MCTS engine{memory_limit};
+    engine.search(0.01f, 1).wait();
+
+    return EngineSpeed{
+        std::chrono::duration<double, std::milli>(Clock::now() - construction_start).count(),
+    };
+}
+
+int main(int argc, char** argv) {
+    float seconds = 2.f;
+    int memory_limit_mb = 1024;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view option = argv[i];
+
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        const char* value = argv[++i];
+
+        bool is_valid = true;
+        if (option == "--seconds") {
+            is_valid = parse_positive(value, seconds);
+        } else if (option == "--memory") {
+            is_valid = parse_positive(value, memory_limit_mb);
+        } else {
+            is_valid = false;
+        }
+
+        if (!is_valid) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const auto playouts = measure_playouts(seconds);
+    const auto engine = measure_engine(static_cast<std::size_t>(memory_limit_mb) * 1024 * 1024);
+
+    std::printf("build                   %s\n", BUILD_NAME);
+
+    std::printf("\nYngine\n");
+    std::printf("startup ms              %.1f\n", engine.startup_ms);
+
+    std::printf("\nBoard rules of the game\n");
+    std::printf("playouts/s              %.0f\n", playouts.playouts_per_second);
+    std::printf("move generations/s      %.0f\n", playouts.generations_per_second);
+    std::printf("generated moves/s       %.0f\n", playouts.moves_per_second);
+
+    return 0;
+}